@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Stand-in Ollama nodes for exercising OllamaBotControl.Url load balancing.
+
+Starts one small HTTP server per --node, each answering /api/generate with a
+canned reply in the shape the module asked for (command, goal or batch) and
+/api/tags for the health checks. Nodes can be made slow, broken or flapping, so
+the weighted balancing, sticky routing, failover and health checks of the
+endpoint pool can be watched from both sides without a GPU:
+
+    python3 fake_ollama.py --node 11501 --node 11502:slow=0.5 --node 11503:fail
+
+and in mod_ollama_bot_buddy.conf:
+
+    OllamaBotControl.Url = http://127.0.0.1:11501/api/generate;2,http://127.0.0.1:11502/api/generate,http://127.0.0.1:11503/api/generate
+    OllamaBotControl.Endpoints.FailureThreshold = 2
+    OllamaBotControl.Endpoints.RetrySeconds = 15
+    OllamaBotControl.Endpoints.HealthCheckSeconds = 10
+
+What to look for, in this script's output and in `.buddy stats` on the server:
+  - 11501 takes about twice the requests of 11502 (weight 2 against 1)
+  - 11503 is marked unhealthy after two failures and only sees health checks
+    until it is retried; restart it as a healthy node to watch it come back
+  - a bot named in a prompt keeps landing on the same node; every move to
+    another node is printed as "moved", and should only follow a failure or
+    a load difference larger than Endpoints.StickySlack
+
+Node modes:
+  ok           answer normally (default)
+  slow=S       wait S seconds before answering
+  fail         HTTP 500 for generate and health checks
+  flap=S       alternate between ok and fail every S seconds
+"""
+
+import argparse
+import json
+import re
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+NAME_PATTERN = re.compile(r"^(?:Name: (.+)|=== BOT: (.+) ===)$", re.MULTILINE)
+
+lock = threading.Lock()
+requests_by_node = {}
+health_checks_by_node = {}
+node_by_bot = {}
+
+
+class Node:
+    def __init__(self, spec):
+        port, _, mode = spec.partition(":")
+        self.port = int(port)
+        self.mode, _, value = (mode or "ok").partition("=")
+        self.value = float(value) if value else 0.0
+        if self.mode not in ("ok", "slow", "fail", "flap"):
+            raise argparse.ArgumentTypeError(f"unknown node mode '{self.mode}'")
+        self.started = time.monotonic()
+
+    def failing(self):
+        if self.mode == "fail":
+            return True
+        if self.mode == "flap":
+            return int((time.monotonic() - self.started) / self.value) % 2 == 1
+        return False
+
+
+def make_reply(request):
+    """A reply that satisfies the schema sent in "format"; the bots just stop."""
+    properties = request.get("format", {}).get("properties", {})
+    if "commands" in properties:
+        return {"commands": []}
+    if "goal" in properties:
+        return {"goal": {"type": "follow", "params": {}}, "reasoning": "stand-in node", "say": ""}
+    return {"command": {"type": "stop", "params": {}}, "reasoning": "stand-in node", "say": ""}
+
+
+def final_line(prompt, tokens, started):
+    elapsed = int((time.monotonic() - started) * 1e9)
+    return {
+        "done": True,
+        "prompt_eval_count": max(1, len(prompt) // 4),
+        "prompt_eval_duration": elapsed // 4,
+        "eval_count": tokens,
+        "eval_duration": elapsed // 2,
+        "load_duration": 1000000,
+        "total_duration": elapsed,
+    }
+
+
+def make_handler(node):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.0"
+
+        def log_message(self, format, *args):
+            pass
+
+        def do_GET(self):
+            with lock:
+                health_checks_by_node[node.port] = health_checks_by_node.get(node.port, 0) + 1
+            if self.path != "/api/tags":
+                self.send_error(404)
+                return
+            if node.failing():
+                self.send_error(500)
+                return
+            self.send_json({"models": []})
+
+        def do_POST(self):
+            started = time.monotonic()
+            if self.path != "/api/generate":
+                self.send_error(404)
+                return
+
+            request = json.loads(self.rfile.read(int(self.headers.get("Content-Length", 0))) or b"{}")
+            prompt = request.get("prompt", "")
+            self.note_request(prompt)
+
+            if node.failing():
+                self.send_error(500)
+                return
+            if node.mode == "slow":
+                time.sleep(node.value)
+
+            text = json.dumps(make_reply(request))
+            if not request.get("stream", False):
+                reply = {"response": text}
+                reply.update(final_line(prompt, len(text) // 4, started))
+                self.send_json(reply)
+                return
+
+            # One NDJSON line per "token", then the final line with the counters
+            self.send_response(200)
+            self.send_header("Content-Type", "application/x-ndjson")
+            self.end_headers()
+            tokens = [text[i:i + 4] for i in range(0, len(text), 4)]
+            try:
+                for token in tokens:
+                    self.wfile.write((json.dumps({"response": token, "done": False}) + "\n").encode())
+                    self.wfile.flush()
+                    time.sleep(0.01)
+                line = final_line(prompt, len(tokens), started)
+                line["response"] = ""
+                self.wfile.write((json.dumps(line) + "\n").encode())
+            except (BrokenPipeError, ConnectionResetError):
+                pass  # the module closes the stream once it has the object
+
+        def note_request(self, prompt):
+            with lock:
+                requests_by_node[node.port] = requests_by_node.get(node.port, 0) + 1
+                for name in (single or batch for single, batch in NAME_PATTERN.findall(prompt)):
+                    previous = node_by_bot.get(name)
+                    if previous is not None and previous != node.port:
+                        print(f"moved: {name} {previous} -> {node.port}", flush=True)
+                    node_by_bot[name] = node.port
+
+        def send_json(self, body):
+            data = json.dumps(body).encode()
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(data)))
+            self.end_headers()
+            self.wfile.write(data)
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--node", action="append", type=Node, metavar="PORT[:MODE]",
+                        help="start a stand-in node; repeat for each node")
+    parser.add_argument("--report", type=float, default=10.0, metavar="SECONDS",
+                        help="how often to print request counts (default: 10)")
+    args = parser.parse_args()
+    nodes = args.node or [Node("11501"), Node("11502:slow=0.5"), Node("11503:fail")]
+
+    for node in nodes:
+        server = ThreadingHTTPServer(("127.0.0.1", node.port), make_handler(node))
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        print(f"node {node.port}: {node.mode}{'=' + str(node.value) if node.value else ''}", flush=True)
+
+    try:
+        while True:
+            time.sleep(args.report)
+            with lock:
+                counts = ", ".join(f"{node.port}: {requests_by_node.get(node.port, 0)} requests "
+                                   f"{health_checks_by_node.get(node.port, 0)} health checks" for node in nodes)
+            print(counts, flush=True)
+    except KeyboardInterrupt:
+        return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,7 @@
+-- Bots controlled by mod-ollama-bot-buddy, added with `.buddy enroll`.
+-- Bots listed in OllamaBotControl.Enroll.Names do not need a row.
+CREATE TABLE IF NOT EXISTS `mod_ollama_bot_buddy_enrollment` (
+  `guid` INT UNSIGNED NOT NULL COMMENT 'characters.guid of the bot',
+  `enrolled_at` TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`guid`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
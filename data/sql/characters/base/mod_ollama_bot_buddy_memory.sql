@@ -0,0 +1,11 @@
+-- Recent commands of each LLM-controlled bot with the reasoning behind them,
+-- shown back to the model in its prompt. A ring: `slot` is `seq` modulo the
+-- history size, so a bot never has more than that many rows.
+CREATE TABLE IF NOT EXISTS `mod_ollama_bot_buddy_memory` (
+  `guid` INT UNSIGNED NOT NULL COMMENT 'characters.guid of the bot',
+  `slot` TINYINT UNSIGNED NOT NULL,
+  `seq` INT UNSIGNED NOT NULL COMMENT 'write order, highest is newest',
+  `command` VARCHAR(255) NOT NULL,
+  `reasoning` VARCHAR(255) NOT NULL DEFAULT '',
+  PRIMARY KEY (`guid`, `slot`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
@@ -1,6 +1,9 @@
 #include "mod-ollama-bot-buddy_config.h"
 #include "mod-ollama-bot-buddy_loop.h"
 #include "mod-ollama-bot-buddy_handler.h"
+#include "mod-ollama-bot-buddy_wake.h"
+#include "mod-ollama-bot-buddy_enrollment.h"
+#include "mod-ollama-bot-buddy_gmcommands.h"
 
 #include "Log.h"
 
@@ -10,4 +13,7 @@ void Addmod_ollama_bot_buddyScripts()
     LOG_INFO("server.loading", "Registering mod-ollama-bot-buddy scripts.");
     new OllamaBotControlLoop();
     new BotBuddyChatHandler();
+    new BotBuddyWakeEvents();
+    new BotBuddyEnrollmentScript();
+    new BotBuddyCommandScript();
 }
@@ -1,6 +1,9 @@
 #include "mod-ollama-bot-buddy_api.h"
+#include "mod-ollama-bot-buddy_commands.h"
 #include "mod-ollama-bot-buddy_config.h"
 #include "mod-ollama-bot-buddy_loop.h"
+#include "mod-ollama-bot-buddy_metrics.h"
+#include "mod-ollama-bot-buddy_pathing.h"
 #include "Playerbots.h"
 #include "PlayerbotAI.h"
 #include "ObjectAccessor.h"
@@ -17,14 +20,113 @@
 #include "WorldPacket.h"
 #include "WorldSession.h"
 #include "GossipDef.h"
+#include "MoveSpline.h"
+#include "SpellMgr.h"
+#include <chrono>
+#include <cmath>
 #include <sstream>
+#include <unordered_map>
 
 // Constants for interaction and combat ranges
 #define INTERACTION_DISTANCE 5.5f
 #define ATTACK_DISTANCE 5.0f
 
+// Interact/attack that had to walk first and finishes once the bot is in range
+struct BotBuddyPendingAction
+{
+    BotBuddyPendingActionType type;
+    ObjectGuid target;
+    std::chrono::steady_clock::time_point expires;
+};
+
+// World thread only
+static std::unordered_map<uint64_t, BotBuddyPendingAction> botPendingActions;
+
 namespace BotBuddyAI
 {
+    static void SetPendingAction(Player* bot, BotBuddyPendingActionType type, ObjectGuid target)
+    {
+        BotBuddyPendingAction& pending = botPendingActions[bot->GetGUID().GetRawValue()];
+        pending.type = type;
+        pending.target = target;
+        pending.expires = std::chrono::steady_clock::now() + std::chrono::seconds(g_OllamaBotControlContinuationTimeoutSeconds);
+    }
+
+    bool HasPendingAction(Player* bot)
+    {
+        return bot && botPendingActions.find(bot->GetGUID().GetRawValue()) != botPendingActions.end();
+    }
+
+    void CancelPendingAction(Player* bot)
+    {
+        if (bot)
+            botPendingActions.erase(bot->GetGUID().GetRawValue());
+    }
+
+    void UpdatePendingAction(Player* bot)
+    {
+        if (!bot) return;
+
+        auto it = botPendingActions.find(bot->GetGUID().GetRawValue());
+        if (it == botPendingActions.end()) return;
+
+        BotBuddyPendingAction pending = it->second;
+        if (std::chrono::steady_clock::now() >= pending.expires)
+        {
+            if (g_EnableOllamaBotBuddyDebug) {
+                LOG_INFO("server.loading", "[OllamaBotBuddy] Bot {} gave up walking to its target", bot->GetName());
+            }
+            botPendingActions.erase(it);
+            return;
+        }
+
+        if (pending.type == BotBuddyPendingActionType::Attack)
+        {
+            Unit* target = ObjectAccessor::GetUnit(*bot, pending.target);
+            if (!target || !target->IsAlive())
+            {
+                botPendingActions.erase(it);
+                return;
+            }
+
+            if (bot->GetExactDist2d(target) > bot->GetMeleeRange(target)) return;
+
+            botPendingActions.erase(it);
+            Attack(bot, pending.target);
+            return;
+        }
+
+        bool inRange = false;
+        bool targetFound = false;
+        if (Creature* creature = ObjectAccessor::GetCreature(*bot, pending.target))
+        {
+            targetFound = true;
+            inRange = bot->GetDistance(creature) <= INTERACTION_DISTANCE;
+        }
+        else if (GameObject* go = ObjectAccessor::GetGameObject(*bot, pending.target))
+        {
+            targetFound = true;
+            inRange = bot->GetDistance(go) <= go->GetInteractionDistance();
+        }
+
+        if (!targetFound)
+        {
+            botPendingActions.erase(it);
+            return;
+        }
+
+        if (!inRange)
+        {
+            // Walked as far as the path goes and still out of reach
+            if (bot->movespline->Finalized())
+                botPendingActions.erase(it);
+            return;
+        }
+
+        botPendingActions.erase(it);
+        Interact(bot, pending.target);
+    }
+
     bool MoveTo(Player* bot, float x, float y, float z)
     {
         if (!bot) return false;
@@ -45,19 +147,22 @@ namespace BotBuddyAI
             }
             return false;
         }
-        
+
+        // Normally a cache hit: ValidateBotControlCommand pathed this destination just before
+        const BotBuddyValidatedPath& path = sBotBuddyPathCache->Get(bot, x, y, z);
+        if (path.type & PATHFIND_NOPATH) return false;
+
         // Clear existing movement
         bot->GetMotionMaster()->Clear(false);
         bot->StopMoving();
-        
-        // Use direct movement for immediate response
-        bot->GetMotionMaster()->MovePoint(0, x, y, z);
-        
-        // Also try using the bot's AI movement system as backup
-        std::ostringstream coords;
-        coords << x << ";" << y << ";" << z;
-        Event event = Event("", coords.str());
-        ai->DoSpecificAction("go", event);
+
+        // Already standing on the destination
+        if (path.points.size() < 2) return true;
+
+        // Follow the validated points directly instead of letting MovePoint path again
+        Movement::PointsArray points = path.points;
+        points.front() = G3D::Vector3(bot->GetPositionX(), bot->GetPositionY(), bot->GetPositionZ());
+        bot->GetMotionMaster()->MoveSplinePath(&points);
         
         if (g_EnableOllamaBotBuddyDebug) {
             float distance = sqrt(pow(x - bot->GetPositionX(), 2) + 
@@ -174,8 +279,9 @@ namespace BotBuddyAI
             // Also use playerbot AI movement action as backup
             Event moveEvent = Event("", "");
             ai->DoSpecificAction("reach melee", moveEvent);
-            
-            return true; // Movement initiated, attack will happen when in range
+
+            SetPendingAction(bot, BotBuddyPendingActionType::Attack, guid);
+            return true; // Movement initiated, UpdatePendingAction attacks once in range
         }
         
         // We're in melee range - initiate combat
@@ -243,7 +349,8 @@ namespace BotBuddyAI
                 
                 bot->GetMotionMaster()->Clear();
                 bot->GetMotionMaster()->MovePoint(0, destX, destY, destZ);
-                return true; // Movement initiated, interaction will happen next cycle
+                SetPendingAction(bot, BotBuddyPendingActionType::Interact, guid);
+                return true; // Movement initiated, UpdatePendingAction interacts on arrival
             }
             
             // Check if this is a quest giver and handle quest interaction properly
@@ -280,7 +387,8 @@ namespace BotBuddyAI
                 
                 bot->GetMotionMaster()->Clear();
                 bot->GetMotionMaster()->MovePoint(0, destX, destY, destZ);
-                return true; // Movement initiated, interaction will happen next cycle
+                SetPendingAction(bot, BotBuddyPendingActionType::Interact, guid);
+                return true; // Movement initiated, UpdatePendingAction interacts on arrival
             }
             
             // Check if this is a quest giver game object
@@ -765,403 +873,260 @@ namespace BotBuddyAI
 
 } // namespace BotBuddyAI
 
-bool HandleBotControlCommand(Player* bot, const BotControlCommand& command)
+static Creature* FindCreatureByLowGuid(Player* bot, uint32 lowGuid)
 {
-    if (g_EnableOllamaBotBuddyDebug && bot)
+    for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore())
     {
-        LOG_INFO("server.loading", "[OllamaBotBuddy] HandleBotControlCommand for '{}', type {}", bot->GetName(), int(command.type));
-        LOG_INFO("server.loading", "[OllamaBotBuddy] ================================================================================================");
+        Creature* c = pair.second;
+        if (c && c->GetGUID().GetCounter() == lowGuid)
+            return c;
     }
-    if (!bot) return false;
-    switch (command.type)
+    return nullptr;
+}
+
+static GameObject* FindGameObjectByLowGuid(Player* bot, uint32 lowGuid)
+{
+    for (auto const& pair : bot->GetMap()->GetGameObjectBySpawnIdStore())
     {
-        case BotControlCommandType::MoveTo:
-            if (command.args.size() >= 3)
-            {
-                float x = std::stof(command.args[0]);
-                float y = std::stof(command.args[1]);
-                float z = std::stof(command.args[2]);
-                return BotBuddyAI::MoveTo(bot, x, y, z);
-            }
-            break;
-        case BotControlCommandType::Attack:
-            if (!command.args.empty())
-            {
-                uint32 lowGuid = 0;
-                try {
-                    lowGuid = std::stoul(command.args[0]);
-                } catch (const std::invalid_argument& e) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid argument for lowGuid '{}'", command.args[0]);
-                    return false;
-                } catch (const std::out_of_range& e) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Out of range value for lowGuid '{}'", command.args[0]);
-                    return false;
-                }
+        GameObject* go = pair.second;
+        if (go && go->GetGUID().GetCounter() == lowGuid)
+            return go;
+    }
+    return nullptr;
+}
 
-                // Try to find the Creature by LowGuid first
-                Creature* creatureTarget = nullptr;
-                for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore())
-                {
-                    Creature* c = pair.second;
-                    if (!c) continue;
-                    if (c->GetGUID().GetCounter() == lowGuid)
-                    {
-                        creatureTarget = c;
-                        break;
-                    }
-                }
+// Creatures first, then players, the same order the prompt lists them in
+static Unit* FindUnitByLowGuid(Player* bot, uint32 lowGuid)
+{
+    if (Creature* creature = FindCreatureByLowGuid(bot, lowGuid))
+        return creature;
+    return ObjectAccessor::FindConnectedPlayer(ObjectGuid::Create<HighGuid::Player>(lowGuid));
+}
 
-                if (creatureTarget)
-                {
-                    // Use the actual GUID from the creature, never reconstruct!
-                    return BotBuddyAI::Attack(bot, creatureTarget->GetGUID());
-                }
+static Unit* FindAttackTarget(Player* bot, const BotBuddyCmd::Attack& cmd)
+{
+    if (!cmd.target.IsEmpty())
+        return ObjectAccessor::GetUnit(*bot, cmd.target);
+    return FindUnitByLowGuid(bot, cmd.guid);
+}
 
-                // If not found, try Player
-                ObjectGuid guid = ObjectGuid::Create<HighGuid::Player>(lowGuid);
-                Player* playerTarget = ObjectAccessor::FindConnectedPlayer(guid);
-                if (playerTarget)
-                {
-                    return BotBuddyAI::Attack(bot, playerTarget->GetGUID());
-                }
+static WorldObject* FindInteractTarget(Player* bot, const BotBuddyCmd::Interact& cmd)
+{
+    if (!cmd.target.IsEmpty())
+    {
+        if (cmd.target.IsGameObject())
+            return ObjectAccessor::GetGameObject(*bot, cmd.target);
+        return ObjectAccessor::GetCreature(*bot, cmd.target);
+    }
+    if (Creature* creature = FindCreatureByLowGuid(bot, cmd.guid))
+        return creature;
+    return FindGameObjectByLowGuid(bot, cmd.guid);
+}
 
-                LOG_INFO("server.loading", "[OllamaBotBuddy] Could not find target with lowGuid {}", lowGuid);
+namespace
+{
+    struct BotControlCommandValidator
+    {
+        Player* bot;
+
+        bool operator()(const BotBuddyCmd::MoveTo& cmd) const
+        {
+            // Basic coordinate validation - reject obviously invalid coordinates
+            if (!std::isfinite(cmd.x) || !std::isfinite(cmd.y) || !std::isfinite(cmd.z))
+            {
+                LOG_DEBUG("server.loading", "[OllamaBotBuddy] Invalid coordinates for move_to: ({}, {}, {})", cmd.x, cmd.y, cmd.z);
                 return false;
             }
-            break;
-        case BotControlCommandType::Interact:
-            if (!command.args.empty())
+
+            // Validate map bounds - reject coordinates that are extremely far from bot
+            float maxDistanceFromBot = 500.0f; // Maximum reasonable movement distance
+            float distanceFromBot = bot->GetExactDist(cmd.x, cmd.y, cmd.z);
+            if (distanceFromBot > maxDistanceFromBot)
             {
-                uint32 lowGuid = 0;
-                try {
-                    lowGuid = std::stoul(command.args[0]);
-                } catch (const std::invalid_argument& e) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid argument for lowGuid '{}'", command.args[0]);
-                    return false;
-                } catch (const std::out_of_range& e) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Out of range value for lowGuid '{}'", command.args[0]);
-                    return false;
-                }
-                Creature* creatureTarget = nullptr;
-                GameObject* goTarget = nullptr;
+                LOG_DEBUG("server.loading", "[OllamaBotBuddy] Move_to destination too far from bot: ({}, {}, {}) - Distance: {:.1f}",
+                    cmd.x, cmd.y, cmd.z, distanceFromBot);
+                return false;
+            }
 
-                // Find creature by LowGuid
-                for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore())
-                {
-                    Creature* c = pair.second;
-                    if (!c) continue;
-                    if (c->GetGUID().GetCounter() == lowGuid)
-                    {
-                        creatureTarget = c;
-                        break;
-                    }
-                }
+            // Validate that the destination is pathable like a real player would
+            PathType pathType = sBotBuddyPathCache->Get(bot, cmd.x, cmd.y, cmd.z).type;
 
-                if (creatureTarget)
-                {
-                    return BotBuddyAI::Interact(bot, creatureTarget->GetGUID());
-                }
+            // Only reject if there's absolutely no path possible
+            if (pathType & PATHFIND_NOPATH)
+            {
+                LOG_DEBUG("server.loading", "[OllamaBotBuddy] No valid path for move_to: ({}, {}, {}) - PathType: {}",
+                    cmd.x, cmd.y, cmd.z, pathType);
+                return false;
+            }
+            return true;
+        }
 
-                // Find gameobject by LowGuid
-                for (auto const& pair : bot->GetMap()->GetGameObjectBySpawnIdStore())
-                {
-                    GameObject* go = pair.second;
-                    if (!go) continue;
-                    if (go->GetGUID().GetCounter() == lowGuid)
-                    {
-                        goTarget = go;
-                        break;
-                    }
-                }
+        bool operator()(const BotBuddyCmd::Attack& cmd) const
+        {
+            Unit* target = FindAttackTarget(bot, cmd);
+            if (target && target->IsInWorld() && target->IsAlive() &&
+                bot->IsWithinLOSInMap(target) &&
+                bot->IsValidAttackTarget(target) &&
+                bot->IsWithinDistInMap(target, 100.0f)) // Reasonable attack range
+            {
+                return true;
+            }
 
-                if (goTarget)
-                {
-                    return BotBuddyAI::Interact(bot, goTarget->GetGUID());
-                }
+            LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid or unreachable attack target with guid: {} - Target not found in visible creatures/players", cmd.guid);
 
-                LOG_INFO("server.loading", "[OllamaBotBuddy] Could not find interact target with lowGuid {}", lowGuid);
-                return false;
-            }
-            break;
-        case BotControlCommandType::CastSpell:
-            if (!command.args.empty())
+            // Debug: List available creature GUIDs for debugging
+            if (g_EnableOllamaBotBuddyDebug)
             {
-                uint32 spellId = 0;
-                try {
-                    spellId = std::stoi(command.args[0]);
-                } catch (const std::invalid_argument& e) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid argument for spellId '{}'", command.args[0]);
-                    return false;
-                } catch (const std::out_of_range& e) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Out of range value for spellId '{}'", command.args[0]);
-                    return false;
-                }
-                Unit* target = nullptr;
-                if (command.args.size() > 1)
+                std::ostringstream guidList;
+                size_t listed = 0;
+                for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore())
                 {
-                    uint32 lowGuid = 0;
-        try {
-            lowGuid = std::stoul(command.args[1]);
-        } catch (const std::invalid_argument& e) {
-            LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid argument for lowGuid '{}'", command.args[1]);
+                    Creature* c = pair.second;
+                    if (!c || !bot->IsWithinDistInMap(c, 100.0f)) continue;
+                    if (listed++) guidList << ", ";
+                    guidList << c->GetGUID().GetCounter();
+                    if (listed == 10) break;
+                }
+                LOG_DEBUG("server.loading", "[OllamaBotBuddy] Available creature GUIDs: {}", guidList.str());
+            }
             return false;
-        } catch (const std::out_of_range& e) {
-            LOG_ERROR("server.loading", "[OllamaBotBuddy] Out of range value for lowGuid '{}'", command.args[1]);
+        }
+
+        bool operator()(const BotBuddyCmd::Interact& cmd) const
+        {
+            if (FindInteractTarget(bot, cmd))
+                return true;
+
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Could not find interact target with lowGuid {}", cmd.guid);
             return false;
         }
-                    // Try to find creature by lowGuid
-                    for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore())
-                    {
-                        Creature* c = pair.second;
-                        if (c && c->GetGUID().GetCounter() == lowGuid)
-                        {
-                            target = c;
-                            break;
-                        }
-                    }
-                    // Try to find player by lowGuid if not found
-                    if (!target)
-                    {
-                        ObjectGuid guid = ObjectGuid::Create<HighGuid::Player>(lowGuid);
-                        Player* playerTarget = ObjectAccessor::FindConnectedPlayer(guid);
-                        if (playerTarget) target = playerTarget;
-                    }
-                }
-                else
-                {
-                    target = bot; // Use bot itself as the target if no guid provided
-                }
-                return BotBuddyAI::CastSpell(bot, spellId, target);
-            }
-            break;
-        case BotControlCommandType::Say:
-            if (!command.args.empty())
-            {
-                return BotBuddyAI::Say(bot, command.args[0]);
-            }
-            break;
-        case BotControlCommandType::Follow:
-            return BotBuddyAI::FollowMaster(bot);
-        case BotControlCommandType::Stop:
-            return BotBuddyAI::StopMoving(bot);
-        case BotControlCommandType::AcceptQuest:
-            if (!command.args.empty())
+
+        bool operator()(const BotBuddyCmd::CastSpell& cmd) const
+        {
+            if (!sSpellMgr->GetSpellInfo(cmd.spellId))
             {
-                uint32 questId = std::stoi(command.args[0]);
-                return BotBuddyAI::AcceptQuest(bot, questId);
+                LOG_ERROR("server.loading", "[OllamaBotBuddy] Unknown spell id {}", cmd.spellId);
+                return false;
             }
-            break;
-        case BotControlCommandType::TurnInQuest:
-            if (!command.args.empty())
+            if (cmd.targetGuid && !FindUnitByLowGuid(bot, cmd.targetGuid))
             {
-                uint32 questId = std::stoi(command.args[0]);
-                return BotBuddyAI::TurnInQuest(bot, questId);
+                LOG_INFO("server.loading", "[OllamaBotBuddy] Could not find spell target with lowGuid {}", cmd.targetGuid);
+                return false;
             }
-            break;
-        case BotControlCommandType::Loot:
-            return BotBuddyAI::LootNearby(bot);
-        default:
-            break;
-    }
-    return false;
-}
-
-
-bool ParseBotControlCommand(Player* bot, const std::string& commandStr)
-{
-    if (g_EnableOllamaBotBuddyDebug && bot)
-    {
-        LOG_INFO("server.loading", "[OllamaBotBuddy] ParseBotControlCommand for '{}': {}", bot->GetName(), commandStr);
-    }
-    std::istringstream iss(commandStr);
-    std::string cmd;
-    iss >> cmd;
-    if (cmd == "move")
-    {
-        std::string to;
-        iss >> to;
-        if (to != "to") return false;
-        float x, y, z;
-        iss >> x >> y >> z;
-        BotControlCommand command = {BotControlCommandType::MoveTo, {std::to_string(x), std::to_string(y), std::to_string(z)}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
-        {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            return true;
         }
-        return result;
-    }
-    else if (cmd == "attack")
-    {
-        std::string guid;
-        iss >> guid;
-        BotControlCommand command = {BotControlCommandType::Attack, {guid}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::Say& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            return !cmd.message.empty();
         }
-        return result;
-    }
-    else if (cmd == "interact")
-    {
-        std::string guid;
-        iss >> guid;
-        BotControlCommand command = {BotControlCommandType::Interact, {guid}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::AcceptQuest& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            return IsKnownQuest(cmd.questId);
         }
-        return result;
-    }
-    else if (cmd == "say")
-    {
-        std::string msg;
-        std::getline(iss, msg);
-        BotControlCommand command = {BotControlCommandType::Say, {msg}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::TurnInQuest& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            return IsKnownQuest(cmd.questId);
         }
-        return result;
-    }
-    else if (cmd == "loot")
-    {
-        BotControlCommand command = {BotControlCommandType::Loot, {}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::Loot&) const { return true; }
+        bool operator()(const BotBuddyCmd::Follow&) const { return true; }
+        bool operator()(const BotBuddyCmd::Stop&) const { return true; }
+
+        static bool IsKnownQuest(uint32 questId)
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            if (sObjectMgr->GetQuestTemplate(questId)) return true;
+
+            LOG_ERROR("server.loading", "[OllamaBotBuddy] Unknown quest id {}", questId);
+            return false;
         }
-        return result;
-    }
-    else if (cmd == "follow")
+    };
+
+    struct BotControlCommandExecutor
     {
-        BotControlCommand command = {BotControlCommandType::Follow, {}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+        Player* bot;
+
+        bool operator()(const BotBuddyCmd::MoveTo& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            return BotBuddyAI::MoveTo(bot, cmd.x, cmd.y, cmd.z);
         }
-        return result;
-    }
-    else if (cmd == "stop")
-    {
-        BotControlCommand command = {BotControlCommandType::Stop, {}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::Attack& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            // Use the actual GUID from the target, never reconstruct!
+            if (Unit* target = FindAttackTarget(bot, cmd))
+                return BotBuddyAI::Attack(bot, target->GetGUID());
+
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Could not find target with lowGuid {}", cmd.guid);
+            return false;
         }
-        return result;
-    }
-    else if (cmd == "acceptquest")
-    {
-        uint32 questId;
-        iss >> questId;
-        BotControlCommand command = {BotControlCommandType::AcceptQuest, {std::to_string(questId)}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::Interact& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            if (WorldObject* target = FindInteractTarget(bot, cmd))
+                return BotBuddyAI::Interact(bot, target->GetGUID());
+
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Could not find interact target with lowGuid {}", cmd.guid);
+            return false;
         }
-        return result;
-    }
-    else if (cmd == "turninquest")
-    {
-        uint32 questId;
-        iss >> questId;
-        BotControlCommand command = {BotControlCommandType::TurnInQuest, {std::to_string(questId)}};
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
+
+        bool operator()(const BotBuddyCmd::CastSpell& cmd) const
         {
-            AddBotCommandHistory(bot, FormatCommandString(command));
+            // Use bot itself as the target if no guid provided
+            Unit* target = cmd.targetGuid ? FindUnitByLowGuid(bot, cmd.targetGuid) : bot;
+            return BotBuddyAI::CastSpell(bot, cmd.spellId, target);
         }
-        return result;
-    }
-    else if (cmd == "spell")
+
+        bool operator()(const BotBuddyCmd::Loot&) const { return BotBuddyAI::LootNearby(bot); }
+        bool operator()(const BotBuddyCmd::Follow&) const { return BotBuddyAI::FollowMaster(bot); }
+        bool operator()(const BotBuddyCmd::Say& cmd) const { return BotBuddyAI::Say(bot, cmd.message); }
+        bool operator()(const BotBuddyCmd::AcceptQuest& cmd) const { return BotBuddyAI::AcceptQuest(bot, cmd.questId); }
+        bool operator()(const BotBuddyCmd::TurnInQuest& cmd) const { return BotBuddyAI::TurnInQuest(bot, cmd.questId); }
+        bool operator()(const BotBuddyCmd::Stop&) const { return BotBuddyAI::StopMoving(bot); }
+    };
+}
+
+bool ValidateBotControlCommand(Player* bot, const BotControlCommand& command)
+{
+    if (!bot || !bot->GetMap()) return false;
+    BotBuddyStageTimer validateTimer(BotBuddyStage::Validate);
+    return std::visit(BotControlCommandValidator{ bot }, command);
+}
+
+bool HandleBotControlCommand(Player* bot, const BotControlCommand& command)
+{
+    if (g_EnableOllamaBotBuddyDebug && bot)
     {
-        uint32 spellId;
-        iss >> spellId;
-        std::string targetGuid;
-        iss >> targetGuid;
-        BotControlCommand command;
-        if (!targetGuid.empty())
-        {
-            command = {BotControlCommandType::CastSpell, {std::to_string(spellId), targetGuid}};
-        }
-        else
-        {
-            command = {BotControlCommandType::CastSpell, {std::to_string(spellId)}};
-        }
-        bool result = HandleBotControlCommand(bot, command);
-        if (result)
-        {
-            AddBotCommandHistory(bot, FormatCommandString(command));
-        }
-        return result;
+        LOG_INFO("server.loading", "[OllamaBotBuddy] HandleBotControlCommand for '{}': {}", bot->GetName(), FormatCommandString(command));
+        LOG_INFO("server.loading", "[OllamaBotBuddy] ================================================================================================");
     }
-    return false;
+    if (!bot || !bot->GetMap()) return false;
+
+    BotBuddyStageTimer executeTimer(BotBuddyStage::Execute);
+
+    // A new command replaces whatever the bot was still walking towards
+    BotBuddyAI::CancelPendingAction(bot);
+
+    return std::visit(BotControlCommandExecutor{ bot }, command);
 }
 
-std::string FormatCommandString(const BotControlCommand& command)
+bool ParseBotControlCommand(Player* bot, const std::string& commandStr)
 {
-    std::ostringstream ss;
-    switch (command.type)
+    if (g_EnableOllamaBotBuddyDebug && bot)
     {
-        case BotControlCommandType::MoveTo:
-            ss << "move to";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::Attack:
-            ss << "attack";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::Interact:
-            ss << "interact";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::CastSpell:
-            ss << "cast";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::Loot:
-            ss << "loot";
-            break;
-        case BotControlCommandType::Follow:
-            ss << "follow";
-            break;
-        case BotControlCommandType::Say:
-            ss << "say";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::AcceptQuest:
-            ss << "acceptquest";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::TurnInQuest:
-            ss << "turninquest";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
-        case BotControlCommandType::Stop:
-            ss << "stop";
-            break;
-        default:
-            ss << "unknown command";
-            for (const auto& arg : command.args)
-                ss << " " << arg;
-            break;
+        LOG_INFO("server.loading", "[OllamaBotBuddy] ParseBotControlCommand for '{}': {}", bot->GetName(), commandStr);
     }
-    return ss.str();
-}
 
+    BotControlCommand command;
+    if (!ParseBotControlCommandText(commandStr, command) || !ValidateBotControlCommand(bot, command))
+        return false;
 
+    bool result = HandleBotControlCommand(bot, command);
+    if (result)
+    {
+        AddBotHistory(bot, FormatCommandString(command), "");
+    }
+    return result;
+}
@@ -1,34 +1,54 @@
 #pragma once
 #include "Player.h"
 #include <string>
+#include <variant>
 #include <vector>
 
-enum class BotControlCommandType
+enum class BotBuddyPendingActionType
 {
-    MoveTo,
-    Attack,
     Interact,
-    CastSpell,
-    Loot,
-    Follow,
-    Say,
-    AcceptQuest,
-    TurnInQuest,
-    Stop
+    Attack
 };
 
-struct BotControlCommand
+// One struct per command. GUIDs are the low counters the prompt shows the model.
+// Sources that already hold the object (chat orders, reflexes) also set
+// `target`, which wins: creature, gameobject and player counters overlap.
+namespace BotBuddyCmd
 {
-    BotControlCommandType type;
-    std::vector<std::string> args;
-};
+    struct MoveTo      { float x = 0.0f; float y = 0.0f; float z = 0.0f; };
+    struct Attack      { uint32 guid = 0; ObjectGuid target; };
+    struct Interact    { uint32 guid = 0; ObjectGuid target; };
+    struct CastSpell   { uint32 spellId = 0; uint32 targetGuid = 0; };  // targetGuid 0 casts on self
+    struct Loot        { };
+    struct Follow      { };
+    struct Say         { std::string message; };
+    struct AcceptQuest { uint32 questId = 0; };
+    struct TurnInQuest { uint32 questId = 0; };
+    struct Stop        { };
+}
+
+using BotControlCommand = std::variant<
+    BotBuddyCmd::MoveTo,
+    BotBuddyCmd::Attack,
+    BotBuddyCmd::Interact,
+    BotBuddyCmd::CastSpell,
+    BotBuddyCmd::Loot,
+    BotBuddyCmd::Follow,
+    BotBuddyCmd::Say,
+    BotBuddyCmd::AcceptQuest,
+    BotBuddyCmd::TurnInQuest,
+    BotBuddyCmd::Stop>;
+
+// Shared checks for every command source (LLM JSON, text commands, chat):
+// coordinates are finite, reachable and not too far, targets exist and may be
+// attacked, ids are set. Logs the reason when a command is rejected.
+bool ValidateBotControlCommand(Player* bot, const BotControlCommand& command);
 
 bool HandleBotControlCommand(Player* bot, const BotControlCommand& command);
 bool ParseBotControlCommand(Player* bot, const std::string& commandStr);
 
 std::string FormatCommandString(const BotControlCommand& command);
 
-
 // BotBuddyAI namespace with wrappers for bot actions
 namespace BotBuddyAI
 {
@@ -46,6 +66,11 @@ namespace BotBuddyAI
     bool HasQuestsAvailable(Player* bot, WorldObject* questGiver);
     bool LootNearby(Player* bot);
     bool Interact(Player* bot, ObjectGuid guid);
+
+    /// Interact/Attack started out of range finish here once the bot arrives
+    void UpdatePendingAction(Player* bot);
+    bool HasPendingAction(Player* bot);
+    void CancelPendingAction(Player* bot);
     
     // Quest-related helper functions
     bool InteractWithQuestGiver(Player* bot, WorldObject* questGiver);
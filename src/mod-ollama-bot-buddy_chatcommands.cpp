@@ -0,0 +1,329 @@
+#include "mod-ollama-bot-buddy_chatcommands.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_llm.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "mod-ollama-bot-buddy_plan.h"
+#include "mod-ollama-bot-buddy_prefetch.h"
+#include "mod-ollama-bot-buddy_wake.h"
+#include "Creature.h"
+#include "GameObject.h"
+#include "Map.h"
+#include "Log.h"
+#include <cctype>
+#include <limits>
+#include <fmt/format.h>
+
+// Same radius the prompt lists visible objects in
+static constexpr float CHAT_COMMAND_RANGE = 100.0f;
+// How close "come here" stops to the player
+static constexpr float CHAT_COMMAND_COME_DISTANCE = 2.0f;
+
+static const char* const ChatCommandPatternNames[] = { "come_here", "go_to", "interact_with", "attack" };
+
+namespace
+{
+    struct ChatCommandPhrase
+    {
+        const char* text;
+        BotBuddyChatCommandPattern pattern;
+    };
+
+    // An order has to open with one of these, at the start of the message or
+    // right after the bot's name
+    const ChatCommandPhrase ChatCommandPhrases[] = {
+        { "interact with", BotBuddyChatCommandPattern::InteractWith },
+        { "come to me",    BotBuddyChatCommandPattern::ComeHere },
+        { "come here",     BotBuddyChatCommandPattern::ComeHere },
+        { "go to",         BotBuddyChatCommandPattern::GoTo },
+        { "attack",        BotBuddyChatCommandPattern::Attack },
+    };
+
+    std::string ToLower(std::string text)
+    {
+        for (char& c : text)
+            c = char(std::tolower(uint8(c)));
+        return text;
+    }
+
+    bool IsWordByte(char c)
+    {
+        return std::isalnum(uint8(c)) || c == '\'';
+    }
+
+    // Finds phrase as whole words; npos when absent
+    size_t FindWords(const std::string& text, const std::string& phrase, size_t from = 0)
+    {
+        for (size_t pos = text.find(phrase, from); pos != std::string::npos; pos = text.find(phrase, pos + 1))
+        {
+            size_t end = pos + phrase.size();
+            if ((pos == 0 || !IsWordByte(text[pos - 1])) && (end == text.size() || !IsWordByte(text[end])))
+                return pos;
+        }
+        return std::string::npos;
+    }
+
+    bool StartsWithWords(const std::string& text, size_t pos, const char* phrase)
+    {
+        size_t length = std::char_traits<char>::length(phrase);
+        size_t end = pos + length;
+        return text.compare(pos, length, phrase) == 0 && (end == text.size() || !IsWordByte(text[end]));
+    }
+
+    // Past the spaces, punctuation and greetings or politeness in front of an order
+    size_t SkipToOrder(const std::string& text, size_t pos)
+    {
+        while (true)
+        {
+            pos = text.find_first_not_of(" \t,.!:;-", pos);
+            if (pos == std::string::npos) return text.size();
+
+            const char* filler = nullptr;
+            for (const char* word : { "please", "hey", "ok", "okay" })
+                if (StartsWithWords(text, pos, word))
+                    filler = word;
+            if (!filler) return pos;
+            pos += std::char_traits<char>::length(filler);
+        }
+    }
+
+    // "don't attack", "never go to the mine": left to the model
+    bool IsNegated(const std::string& text)
+    {
+        for (const char* negation : { "don't", "dont", "do not", "never", "stop" })
+            if (FindWords(text, negation) != std::string::npos)
+                return true;
+        return false;
+    }
+
+    // "the Kobold Vermin!" -> "kobold vermin"
+    std::string ExtractTargetName(const std::string& rest)
+    {
+        std::string name = rest.substr(0, rest.find_first_of(".,!?;:"));
+
+        auto trim = [](std::string& text) {
+            size_t first = text.find_first_not_of(" \t");
+            size_t last = text.find_last_not_of(" \t");
+            text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+        };
+
+        trim(name);
+        for (const char* article : { "the ", "that ", "this ", "an ", "a " })
+        {
+            if (name.rfind(article, 0) == 0)
+            {
+                name.erase(0, std::char_traits<char>::length(article));
+                trim(name);
+                break;
+            }
+        }
+        for (const char* filler : { " please", " now" })
+        {
+            size_t length = std::char_traits<char>::length(filler);
+            if (name.size() > length && name.compare(name.size() - length, length, filler) == 0)
+                name.resize(name.size() - length);
+        }
+        return name;
+    }
+
+    // Whole name first, then a visible name that contains what the player
+    // typed ("vermin" for "Kobold Vermin"); the nearest wins within a rank
+    struct NameMatch
+    {
+        WorldObject* object = nullptr;
+        int rank = std::numeric_limits<int>::max();
+        float distance = std::numeric_limits<float>::max();
+
+        void Offer(WorldObject* candidate, const std::string& wanted, float candidateDistance)
+        {
+            std::string candidateName = ToLower(candidate->GetName());
+            int candidateRank;
+            if (candidateName == wanted)
+                candidateRank = 0;
+            else if (FindWords(candidateName, wanted) != std::string::npos)
+                candidateRank = 1;
+            else
+                return;
+
+            if (candidateRank < rank || (candidateRank == rank && candidateDistance < distance))
+            {
+                object = candidate;
+                rank = candidateRank;
+                distance = candidateDistance;
+            }
+        }
+    };
+
+    WorldObject* FindVisibleByName(Player* bot, const std::string& wanted, bool unitsOnly)
+    {
+        NameMatch match;
+        Map* map = bot->GetMap();
+
+        for (auto const& pair : map->GetCreatureBySpawnIdStore())
+        {
+            Creature* creature = pair.second;
+            if (!creature || creature->IsPet() || creature->IsTotem()) continue;
+            if (unitsOnly && !creature->IsAlive()) continue;
+            if (!bot->IsWithinDistInMap(creature, CHAT_COMMAND_RANGE)) continue;
+            if (!bot->IsWithinLOSInMap(creature)) continue;
+            match.Offer(creature, wanted, bot->GetDistance(creature));
+        }
+
+        if (!unitsOnly)
+        {
+            for (auto const& pair : map->GetGameObjectBySpawnIdStore())
+            {
+                GameObject* go = pair.second;
+                if (!go || !go->isSpawned()) continue;
+                if (!bot->IsWithinDistInMap(go, CHAT_COMMAND_RANGE)) continue;
+                if (!bot->IsWithinLOSInMap(go)) continue;
+                match.Offer(go, wanted, bot->GetDistance(go));
+            }
+        }
+        return match.object;
+    }
+}
+
+BotBuddyChatCommands* BotBuddyChatCommands::instance()
+{
+    static BotBuddyChatCommands instance;
+    return &instance;
+}
+
+bool BotBuddyChatCommands::TryHandle(Player* bot, Player* sender, const std::string& message)
+{
+    if (!g_EnableOllamaBotControlChatFastPath || !bot || !sender || !bot->IsAlive()) return false;
+
+    // An order opens the message or follows the bot's name ("Bob, attack that
+    // wolf"); "I saw Bob attack a wolf" or "don't attack" are talk for the model
+    std::string text = ToLower(message);
+    std::string botName = ToLower(bot->GetName());
+    std::vector<size_t> starts = { 0 };
+    for (size_t pos = FindWords(text, botName); pos != std::string::npos; pos = FindWords(text, botName, pos + 1))
+    {
+        size_t end = pos + botName.size();
+        if (SkipToOrder(text, 0) == pos || (end < text.size() && (text[end] == ',' || text[end] == ':')))
+            starts.push_back(end);
+    }
+
+    const ChatCommandPhrase* phrase = nullptr;
+    size_t phraseEnd = 0;
+    for (size_t start : starts)
+    {
+        size_t pos = SkipToOrder(text, start);
+        for (const ChatCommandPhrase& candidate : ChatCommandPhrases)
+        {
+            if (StartsWithWords(text, pos, candidate.text))
+            {
+                phrase = &candidate;
+                phraseEnd = pos + std::char_traits<char>::length(candidate.text);
+                break;
+            }
+        }
+        if (phrase) break;
+    }
+
+    if (!phrase || IsNegated(text))
+    {
+        _passedToModel++;
+        return false;
+    }
+
+    // The name may also close the order ("attack the wolf, Bob")
+    std::string rest = text.substr(phraseEnd);
+    for (size_t pos = FindWords(rest, botName); pos != std::string::npos; pos = FindWords(rest, botName))
+        rest.replace(pos, botName.size(), " ");
+
+    BotBuddyChatCommandPattern pattern = phrase->pattern;
+    if (pattern == BotBuddyChatCommandPattern::ComeHere)
+    {
+        if (sender->GetMap() != bot->GetMap())
+        {
+            _stats[size_t(pattern)].unresolved++;
+            return false;
+        }
+
+        BotBuddyCmd::MoveTo move;
+        sender->GetNearPoint(bot, move.x, move.y, move.z, bot->GetObjectSize(), CHAT_COMMAND_COME_DISTANCE, sender->GetAngle(bot));
+        return Execute(bot, pattern, move);
+    }
+
+    std::string wanted = ExtractTargetName(rest);
+    WorldObject* target = wanted.empty() ? nullptr : FindVisibleByName(bot, wanted, pattern == BotBuddyChatCommandPattern::Attack);
+    if (!target)
+    {
+        // "go to sleep", or a name the bot cannot see: the model may still make sense of it
+        _stats[size_t(pattern)].unresolved++;
+        if (g_EnableOllamaBotBuddyDebug)
+        {
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Chat command {} for bot {}: nothing visible named '{}', asking the LLM",
+                ChatCommandPatternNames[size_t(pattern)], bot->GetName(), wanted);
+        }
+        return false;
+    }
+
+    switch (pattern)
+    {
+        case BotBuddyChatCommandPattern::GoTo:
+        {
+            BotBuddyCmd::MoveTo move;
+            target->GetNearPoint(bot, move.x, move.y, move.z, bot->GetObjectSize(), CONTACT_DISTANCE, target->GetAngle(bot));
+            return Execute(bot, pattern, move);
+        }
+        case BotBuddyChatCommandPattern::InteractWith:
+            return Execute(bot, pattern, BotBuddyCmd::Interact{ target->GetGUID().GetCounter(), target->GetGUID() });
+        case BotBuddyChatCommandPattern::Attack:
+            return Execute(bot, pattern, BotBuddyCmd::Attack{ target->GetGUID().GetCounter(), target->GetGUID() });
+        default:
+            return false;
+    }
+}
+
+bool BotBuddyChatCommands::Execute(Player* bot, BotBuddyChatCommandPattern pattern, const BotControlCommand& command)
+{
+    PatternStats& stats = _stats[size_t(pattern)];
+    if (!ValidateBotControlCommand(bot, command))
+    {
+        stats.unresolved++;
+        return false;
+    }
+
+    // The order replaces whatever the bot was doing or was about to be told to do
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    BotBuddyAI::CancelPendingAction(bot);
+    sBotBuddyPlanExecutor->Cancel(guid, "player command");
+    CancelOllamaRequest(guid);
+    sBotBuddyPrefetcher->Discard(guid);
+
+    bool result = HandleBotControlCommand(bot, command);
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Chat command {} for bot {} handled without the LLM: {} ({})",
+            ChatCommandPatternNames[size_t(pattern)], bot->GetName(), FormatCommandString(command), result ? "ok" : "failed");
+    }
+
+    // A failed order goes to the model along with the message
+    if (!result)
+    {
+        stats.failed++;
+        return false;
+    }
+
+    // Keep it in the command history so the next prompt knows what happened
+    AddBotHistory(bot, FormatCommandString(command), fmt::format("player order ({})", ChatCommandPatternNames[size_t(pattern)]));
+    sBotBuddyPrefetcher->ClearIdle(guid);
+    sBotBuddyWakeScheduler->Sleep(guid);
+    stats.handled++;
+    return true;
+}
+
+std::vector<std::string> BotBuddyChatCommands::GetSummary() const
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < _stats.size(); ++i)
+    {
+        lines.push_back(fmt::format("chat command {}: handled={} failed={} left to the LLM={}",
+            ChatCommandPatternNames[i], _stats[i].handled, _stats[i].failed, _stats[i].unresolved));
+    }
+    lines.push_back(fmt::format("chat messages with no command: {}", _passedToModel));
+    return lines;
+}
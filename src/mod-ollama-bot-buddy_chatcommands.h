@@ -0,0 +1,47 @@
+#pragma once
+#include "mod-ollama-bot-buddy_api.h"
+#include <array>
+#include <string>
+#include <vector>
+
+enum class BotBuddyChatCommandPattern
+{
+    ComeHere,
+    GoTo,
+    InteractWith,
+    Attack,
+    Count
+};
+
+// Player orders the prompt used to spell out for the model: "come here",
+// "go to <name>", "interact with <name>" and "attack <name>", opening the
+// message or right after the bot's name. Names are resolved against what the
+// bot can currently see and the command goes through ValidateBotControlCommand
+// and HandleBotControlCommand without an LLM call. Anything else, a negated
+// order, a name that matches nothing in sight or a command that fails is left
+// for the model. World thread only; chat handlers run there.
+class BotBuddyChatCommands
+{
+public:
+    static BotBuddyChatCommands* instance();
+
+    // True when the message was a command and the bot acted on it
+    bool TryHandle(Player* bot, Player* sender, const std::string& message);
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    struct PatternStats
+    {
+        uint64 handled = 0;
+        uint64 failed = 0;      // validated but HandleBotControlCommand refused it
+        uint64 unresolved = 0;
+    };
+
+    bool Execute(Player* bot, BotBuddyChatCommandPattern pattern, const BotControlCommand& command);
+
+    std::array<PatternStats, size_t(BotBuddyChatCommandPattern::Count)> _stats;
+    uint64 _passedToModel = 0;
+};
+
+#define sBotBuddyChatCommands BotBuddyChatCommands::instance()
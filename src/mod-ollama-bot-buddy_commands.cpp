@@ -0,0 +1,382 @@
+#include "mod-ollama-bot-buddy_commands.h"
+#include "Log.h"
+#include <array>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <fmt/format.h>
+
+namespace
+{
+    // One param of a command, read from params[name] in JSON and positionally in text
+    template<class Command, class Value>
+    struct CommandField
+    {
+        const char* name;
+        Value Command::* member;
+        bool required;
+    };
+
+    template<class Command, class Value>
+    constexpr CommandField<Command, Value> Field(const char* name, Value Command::* member, bool required = true)
+    {
+        return { name, member, required };
+    }
+
+    // JsonName is empty for commands the model cannot pick. TextName may have
+    // several words; only the first one is looked up.
+    template<class Command>
+    struct CommandSpec;
+
+    template<> struct CommandSpec<BotBuddyCmd::MoveTo>
+    {
+        static constexpr std::string_view JsonName = "move_to";
+        static constexpr std::string_view TextName = "move to";
+        static constexpr auto Fields = std::make_tuple(
+            Field("x", &BotBuddyCmd::MoveTo::x),
+            Field("y", &BotBuddyCmd::MoveTo::y),
+            Field("z", &BotBuddyCmd::MoveTo::z));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::Attack>
+    {
+        static constexpr std::string_view JsonName = "attack";
+        static constexpr std::string_view TextName = "attack";
+        static constexpr auto Fields = std::make_tuple(Field("guid", &BotBuddyCmd::Attack::guid));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::Interact>
+    {
+        static constexpr std::string_view JsonName = "interact";
+        static constexpr std::string_view TextName = "interact";
+        static constexpr auto Fields = std::make_tuple(Field("guid", &BotBuddyCmd::Interact::guid));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::CastSpell>
+    {
+        static constexpr std::string_view JsonName = "spell";
+        static constexpr std::string_view TextName = "spell";
+        static constexpr auto Fields = std::make_tuple(
+            Field("spellid", &BotBuddyCmd::CastSpell::spellId),
+            Field("guid", &BotBuddyCmd::CastSpell::targetGuid, false));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::Loot>
+    {
+        static constexpr std::string_view JsonName = "loot";
+        static constexpr std::string_view TextName = "loot";
+        static constexpr auto Fields = std::make_tuple();
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::Follow>
+    {
+        static constexpr std::string_view JsonName = "follow";
+        static constexpr std::string_view TextName = "follow";
+        static constexpr auto Fields = std::make_tuple();
+    };
+
+    // The model talks through the reply's "say" field instead
+    template<> struct CommandSpec<BotBuddyCmd::Say>
+    {
+        static constexpr std::string_view JsonName = "";
+        static constexpr std::string_view TextName = "say";
+        static constexpr auto Fields = std::make_tuple(Field("message", &BotBuddyCmd::Say::message));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::AcceptQuest>
+    {
+        static constexpr std::string_view JsonName = "accept_quest";
+        static constexpr std::string_view TextName = "acceptquest";
+        static constexpr auto Fields = std::make_tuple(Field("id", &BotBuddyCmd::AcceptQuest::questId));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::TurnInQuest>
+    {
+        static constexpr std::string_view JsonName = "turn_in_quest";
+        static constexpr std::string_view TextName = "turninquest";
+        static constexpr auto Fields = std::make_tuple(Field("id", &BotBuddyCmd::TurnInQuest::questId));
+    };
+
+    template<> struct CommandSpec<BotBuddyCmd::Stop>
+    {
+        static constexpr std::string_view JsonName = "stop";
+        static constexpr std::string_view TextName = "stop";
+        static constexpr auto Fields = std::make_tuple();
+    };
+
+    constexpr size_t CommandCount = std::variant_size_v<BotControlCommand>;
+
+    template<size_t Index>
+    using CommandAt = std::variant_alternative_t<Index, BotControlCommand>;
+
+    constexpr std::string_view FirstWord(std::string_view text)
+    {
+        return text.substr(0, text.find(' '));
+    }
+
+    template<size_t... Index>
+    constexpr std::array<std::string_view, CommandCount> MakeJsonNames(std::index_sequence<Index...>)
+    {
+        return { CommandSpec<CommandAt<Index>>::JsonName... };
+    }
+
+    template<size_t... Index>
+    constexpr std::array<std::string_view, CommandCount> MakeTextKeys(std::index_sequence<Index...>)
+    {
+        return { FirstWord(CommandSpec<CommandAt<Index>>::TextName)... };
+    }
+
+    constexpr auto JsonNames = MakeJsonNames(std::make_index_sequence<CommandCount>{});
+    constexpr auto TextKeys = MakeTextKeys(std::make_index_sequence<CommandCount>{});
+
+    // FNV-1a with a seeded offset basis; the seed is searched at compile time
+    // until every name lands in its own slot, so a lookup is one hash, one
+    // table read and one compare.
+    constexpr uint32 HashName(std::string_view name, uint32 seed)
+    {
+        uint32 hash = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            hash ^= uint8(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr size_t HashSlots = 32;
+    // Seeds tried before giving up; a table left with this seed found none
+    constexpr uint32 HashSeedLimit = 1024;
+
+    struct CommandHashTable
+    {
+        uint32 seed = 0;
+        std::array<int8, HashSlots> slots {};
+    };
+
+    constexpr bool FillHashTable(const std::array<std::string_view, CommandCount>& names, CommandHashTable& table)
+    {
+        for (size_t slot = 0; slot < HashSlots; ++slot)
+            table.slots[slot] = -1;
+
+        for (size_t i = 0; i < CommandCount; ++i)
+        {
+            if (names[i].empty()) continue;
+            size_t slot = HashName(names[i], table.seed) % HashSlots;
+            if (table.slots[slot] != -1) return false;
+            table.slots[slot] = int8(i);
+        }
+        return true;
+    }
+
+    constexpr CommandHashTable MakeHashTable(const std::array<std::string_view, CommandCount>& names)
+    {
+        CommandHashTable table;
+        for (table.seed = 0; table.seed < HashSeedLimit; ++table.seed)
+            if (FillHashTable(names, table))
+                return table;
+        return table;
+    }
+
+    constexpr CommandHashTable JsonTable = MakeHashTable(JsonNames);
+    constexpr CommandHashTable TextTable = MakeHashTable(TextKeys);
+
+    static_assert(JsonTable.seed < HashSeedLimit && TextTable.seed < HashSeedLimit, "No collision-free seed for the command names");
+
+    int FindCommand(const CommandHashTable& table, const std::array<std::string_view, CommandCount>& names, std::string_view name)
+    {
+        if (name.empty()) return -1;
+        int index = table.slots[HashName(name, table.seed) % HashSlots];
+        return index >= 0 && names[index] == name ? index : -1;
+    }
+
+    // JSON
+
+    template<class Command, class Value>
+    bool ReadJsonField(const nlohmann::json& params, Command& command, const CommandField<Command, Value>& field)
+    {
+        if (!params.contains(field.name))
+        {
+            if (field.required)
+            {
+                LOG_ERROR("server.loading", "[OllamaBotBuddy] {} missing {}", CommandSpec<Command>::JsonName, field.name);
+                return false;
+            }
+            return true;
+        }
+        command.*field.member = params.at(field.name).template get<Value>();
+        return true;
+    }
+
+    template<class Command>
+    bool ParseJson(const nlohmann::json& params, BotControlCommand& out)
+    {
+        Command command;
+        bool ok = std::apply([&](const auto&... field) {
+            return (ReadJsonField(params, command, field) && ...);
+        }, CommandSpec<Command>::Fields);
+
+        if (ok) out = std::move(command);
+        return ok;
+    }
+
+    // Text
+
+    template<class Command, class Value>
+    bool ReadTextField(std::istringstream& iss, Command& command, const CommandField<Command, Value>& field)
+    {
+        Value value {};
+        bool read;
+        if constexpr (std::is_same_v<Value, std::string>)
+            read = bool(std::getline(iss >> std::ws, value)) && !value.empty();
+        else
+            read = bool(iss >> value);
+
+        if (read)
+            command.*field.member = value;
+        return read || !field.required;
+    }
+
+    template<class Command>
+    bool ParseText(std::istringstream& iss, BotControlCommand& out)
+    {
+        // The keyword's first word is already consumed; match the rest ("move to")
+        std::string_view words = CommandSpec<Command>::TextName;
+        size_t space = words.find(' ');
+        while (space != std::string_view::npos)
+        {
+            words.remove_prefix(space + 1);
+            space = words.find(' ');
+
+            std::string word;
+            if (!(iss >> word) || word != words.substr(0, space)) return false;
+        }
+
+        Command command;
+        bool ok = std::apply([&](const auto&... field) {
+            return (ReadTextField(iss, command, field) && ...);
+        }, CommandSpec<Command>::Fields);
+
+        if (ok) out = std::move(command);
+        return ok;
+    }
+
+    // Formatting
+
+    template<class Command, class Value>
+    void AppendTextField(std::string& text, const Command& command, const CommandField<Command, Value>& field)
+    {
+        const Value& value = command.*field.member;
+        if (!field.required && value == Value {}) return;
+
+        if constexpr (std::is_floating_point_v<Value>)
+            text += fmt::format(" {:.1f}", value);
+        else
+            text += fmt::format(" {}", value);
+    }
+
+    template<class Command>
+    std::string FormatText(const Command& command)
+    {
+        std::string text(CommandSpec<Command>::TextName);
+        std::apply([&](const auto&... field) {
+            (AppendTextField(text, command, field), ...);
+        }, CommandSpec<Command>::Fields);
+        return text;
+    }
+
+    // Schema
+
+    template<class Command, class Value>
+    void AddSchemaField(nlohmann::json& properties, const CommandField<Command, Value>& field)
+    {
+        if constexpr (std::is_floating_point_v<Value>)
+            properties[field.name] = {{"type", "number"}};
+        else if constexpr (std::is_integral_v<Value>)
+            properties[field.name] = {{"type", "integer"}};
+        else
+            properties[field.name] = {{"type", "string"}};
+    }
+
+    using JsonParser = bool (*)(const nlohmann::json&, BotControlCommand&);
+    using TextParser = bool (*)(std::istringstream&, BotControlCommand&);
+
+    template<size_t... Index>
+    constexpr std::array<JsonParser, CommandCount> MakeJsonParsers(std::index_sequence<Index...>)
+    {
+        return { &ParseJson<CommandAt<Index>>... };
+    }
+
+    template<size_t... Index>
+    constexpr std::array<TextParser, CommandCount> MakeTextParsers(std::index_sequence<Index...>)
+    {
+        return { &ParseText<CommandAt<Index>>... };
+    }
+
+    template<size_t... Index>
+    void AddSchemaFields(nlohmann::json& properties, std::index_sequence<Index...>)
+    {
+        auto addCommand = [&](const auto& fields) {
+            std::apply([&](const auto&... field) { (AddSchemaField(properties, field), ...); }, fields);
+        };
+        (((!CommandSpec<CommandAt<Index>>::JsonName.empty()) ? addCommand(CommandSpec<CommandAt<Index>>::Fields) : void()), ...);
+    }
+
+    constexpr auto JsonParsers = MakeJsonParsers(std::make_index_sequence<CommandCount>{});
+    constexpr auto TextParsers = MakeTextParsers(std::make_index_sequence<CommandCount>{});
+}
+
+bool ParseBotControlCommandJson(const std::string& type, const nlohmann::json& params, BotControlCommand& command)
+{
+    int index = FindCommand(JsonTable, JsonNames, type);
+    if (index < 0)
+    {
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] Unknown command type '{}'", type);
+        return false;
+    }
+
+    try
+    {
+        return JsonParsers[index](params, command);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid params for '{}': {}", type, e.what());
+        return false;
+    }
+}
+
+bool ParseBotControlCommandText(const std::string& text, BotControlCommand& command)
+{
+    std::istringstream iss(text);
+    std::string keyword;
+    iss >> keyword;
+
+    int index = FindCommand(TextTable, TextKeys, keyword);
+    return index >= 0 && TextParsers[index](iss, command);
+}
+
+std::string FormatCommandString(const BotControlCommand& command)
+{
+    return std::visit([](const auto& cmd) { return FormatText(cmd); }, command);
+}
+
+nlohmann::json GetBotCommandTypeSchema()
+{
+    nlohmann::json types = nlohmann::json::array();
+    for (std::string_view name : JsonNames)
+        if (!name.empty())
+            types.push_back(std::string(name));
+    return types;
+}
+
+nlohmann::json GetBotCommandParamsSchema()
+{
+    nlohmann::json properties = nlohmann::json::object();
+    AddSchemaFields(properties, std::make_index_sequence<CommandCount>{});
+    return {
+        {"type", "object"},
+        {"properties", properties}
+    };
+}
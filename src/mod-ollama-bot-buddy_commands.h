@@ -0,0 +1,20 @@
+#pragma once
+#include "mod-ollama-bot-buddy_api.h"
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Every command is described once, in the registry in
+// mod-ollama-bot-buddy_commands.cpp: its JSON type name, its text keyword and
+// its params as struct fields. The JSON and text parsers, FormatCommandString
+// and the schema sent to the model are all generated from that table.
+
+// Fills command from an LLM {type, params} pair. Only checks the shape; the
+// caller still runs ValidateBotControlCommand.
+bool ParseBotControlCommandJson(const std::string& type, const nlohmann::json& params, BotControlCommand& command);
+
+// Text form used by in-game commands: "move to x y z", "attack <guid>", ...
+bool ParseBotControlCommandText(const std::string& text, BotControlCommand& command);
+
+// "type" enum and "params" object for the reply schema
+nlohmann::json GetBotCommandTypeSchema();
+nlohmann::json GetBotCommandParamsSchema();
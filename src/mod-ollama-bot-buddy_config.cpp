@@ -1,11 +1,82 @@
 #include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_endpoints.h"
+#include "mod-ollama-bot-buddy_enrollment.h"
 #include "Config.h"
+#include <sstream>
 
 bool g_EnableOllamaBotControl = true;
 std::string g_OllamaBotControlUrl = "http://localhost:11434/api/generate";
 std::string g_OllamaBotControlModel = "llama3.2:1b";
 bool g_EnableOllamaBotBuddyDebug = false;
 bool g_EnableBotBuddyAddon = false;
+bool g_EnableOllamaBotControlStreaming = true;
+bool g_EnableOllamaBotControlStructuredOutput = true;
+uint32 g_OllamaBotControlNumPredict = 256;
+std::vector<std::string> g_OllamaBotControlStopSequences;
+float g_OllamaBotControlTemperature = -1.0f;
+bool g_EnableOllamaBotControlAutoNumPredict = true;
+uint32 g_OllamaBotControlNumPredictPercentile = 95;
+uint32 g_OllamaBotControlNumPredictWindow = 64;
+uint32 g_OllamaBotControlMaxReasoningLength = 200;
+uint32 g_OllamaBotControlMaxSayLength = 120;
+uint32 g_OllamaBotControlConnectTimeoutMs = 2000;
+uint32 g_OllamaBotControlRequestTimeoutMs = 30000;
+bool g_EnableOllamaBotControlCircuitBreaker = true;
+uint32 g_OllamaBotControlBreakerFailureThreshold = 5;
+uint32 g_OllamaBotControlBreakerLatencyThresholdMs = 20000;
+uint32 g_OllamaBotControlBreakerLatencyWindow = 50;
+uint32 g_OllamaBotControlBreakerOpenSeconds = 30;
+uint32 g_OllamaBotControlEndpointStickySlack = 2;
+uint32 g_OllamaBotControlEndpointFailureThreshold = 2;
+uint32 g_OllamaBotControlEndpointRetrySeconds = 15;
+uint32 g_OllamaBotControlEndpointHealthCheckSeconds = 10;
+bool g_EnableOllamaBotControlBatching = false;
+uint32 g_OllamaBotControlBatchSize = 5;
+float g_OllamaBotControlBatchCellSize = 60.0f;
+bool g_EnableOllamaBotControlPlans = true;
+uint32 g_OllamaBotControlPlanMaxSteps = 4;
+float g_OllamaBotControlPlanArrivalDistance = 3.0f;
+uint32 g_OllamaBotControlPlanStepTimeoutSeconds = 30;
+bool g_EnableOllamaBotControlReflexes = true;
+bool g_EnableOllamaBotControlReflexFightBack = true;
+bool g_EnableOllamaBotControlReflexTurnIn = true;
+bool g_EnableOllamaBotControlReflexLoot = true;
+float g_OllamaBotControlReflexLootRange = 15.0f;
+bool g_EnableOllamaBotControlHybrid = false;
+uint32 g_OllamaBotControlHybridGoalSeconds = 120;
+bool g_EnableOllamaBotControlPrefetch = false;
+float g_OllamaBotControlPrefetchMinDistance = 40.0f;
+float g_OllamaBotControlPrefetchTolerance = 8.0f;
+bool g_EnableOllamaBotControlWake = true;
+uint32 g_OllamaBotControlWakeFallbackSeconds = 20;
+uint32 g_OllamaBotControlContinuationTimeoutSeconds = 20;
+uint32 g_OllamaBotControlPathCacheSeconds = 10;
+uint32 g_OllamaBotControlPathWorkers = 2;
+uint32 g_OllamaBotControlChatQueueSize = 8;
+uint32 g_OllamaBotControlChatSenderMessagesPerMinute = 12;
+uint32 g_OllamaBotControlChatMaxBytes = 65536;
+bool g_EnableOllamaBotControlChatCancelInFlight = true;
+bool g_EnableOllamaBotControlChatFastPath = true;
+std::vector<std::string> g_OllamaBotControlEnrollNames;
+bool g_EnableOllamaBotControlMemory = true;
+uint32 g_OllamaBotControlMemoryFlushSeconds = 5;
+uint32 g_OllamaBotControlStreamingStatsGraceMs = 250;
+
+// Splits a comma separated config value, dropping surrounding whitespace and empty entries
+static std::vector<std::string> SplitConfigList(const std::string& value)
+{
+    std::vector<std::string> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        size_t first = item.find_first_not_of(" \t");
+        size_t last = item.find_last_not_of(" \t");
+        if (first == std::string::npos) continue;
+        out.push_back(item.substr(first, last - first + 1));
+    }
+    return out;
+}
 
 OllamaBotControlConfigWorldScript::OllamaBotControlConfigWorldScript() : WorldScript("OllamaBotControlConfigWorldScript") {}
 
@@ -16,4 +87,59 @@ void OllamaBotControlConfigWorldScript::OnStartup()
     g_OllamaBotControlModel = sConfigMgr->GetOption<std::string>("OllamaBotControl.Model", "llama3.2:1b");
     g_EnableOllamaBotBuddyDebug = sConfigMgr->GetOption<bool>("OllamaBotControl.Debug", false);
     g_EnableBotBuddyAddon = sConfigMgr->GetOption<bool>("OllamaBotControl.EnableBotBuddyAddon", false);
+    g_EnableOllamaBotControlStreaming = sConfigMgr->GetOption<bool>("OllamaBotControl.Streaming", true);
+    g_EnableOllamaBotControlStructuredOutput = sConfigMgr->GetOption<bool>("OllamaBotControl.StructuredOutput", true);
+    g_OllamaBotControlNumPredict = sConfigMgr->GetOption<uint32>("OllamaBotControl.NumPredict", 256);
+    g_OllamaBotControlStopSequences = SplitConfigList(sConfigMgr->GetOption<std::string>("OllamaBotControl.StopSequences", ""));
+    g_OllamaBotControlTemperature = sConfigMgr->GetOption<float>("OllamaBotControl.Temperature", -1.0f);
+    g_EnableOllamaBotControlAutoNumPredict = sConfigMgr->GetOption<bool>("OllamaBotControl.AutoNumPredict", true);
+    g_OllamaBotControlNumPredictPercentile = sConfigMgr->GetOption<uint32>("OllamaBotControl.AutoNumPredict.Percentile", 95);
+    g_OllamaBotControlNumPredictWindow = sConfigMgr->GetOption<uint32>("OllamaBotControl.AutoNumPredict.Window", 64);
+    g_OllamaBotControlMaxReasoningLength = sConfigMgr->GetOption<uint32>("OllamaBotControl.MaxReasoningLength", 200);
+    g_OllamaBotControlMaxSayLength = sConfigMgr->GetOption<uint32>("OllamaBotControl.MaxSayLength", 120);
+    g_OllamaBotControlConnectTimeoutMs = sConfigMgr->GetOption<uint32>("OllamaBotControl.ConnectTimeoutMs", 2000);
+    g_OllamaBotControlRequestTimeoutMs = sConfigMgr->GetOption<uint32>("OllamaBotControl.RequestTimeoutMs", 30000);
+    g_EnableOllamaBotControlCircuitBreaker = sConfigMgr->GetOption<bool>("OllamaBotControl.CircuitBreaker.Enable", true);
+    g_OllamaBotControlBreakerFailureThreshold = sConfigMgr->GetOption<uint32>("OllamaBotControl.CircuitBreaker.FailureThreshold", 5);
+    g_OllamaBotControlBreakerLatencyThresholdMs = sConfigMgr->GetOption<uint32>("OllamaBotControl.CircuitBreaker.LatencyThresholdMs", 20000);
+    g_OllamaBotControlBreakerLatencyWindow = sConfigMgr->GetOption<uint32>("OllamaBotControl.CircuitBreaker.LatencyWindow", 50);
+    g_OllamaBotControlBreakerOpenSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.CircuitBreaker.OpenSeconds", 30);
+    g_OllamaBotControlEndpointStickySlack = sConfigMgr->GetOption<uint32>("OllamaBotControl.Endpoints.StickySlack", 2);
+    g_OllamaBotControlEndpointFailureThreshold = sConfigMgr->GetOption<uint32>("OllamaBotControl.Endpoints.FailureThreshold", 2);
+    g_OllamaBotControlEndpointRetrySeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Endpoints.RetrySeconds", 15);
+    g_OllamaBotControlEndpointHealthCheckSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Endpoints.HealthCheckSeconds", 10);
+    g_EnableOllamaBotControlBatching = sConfigMgr->GetOption<bool>("OllamaBotControl.Batch.Enable", false);
+    g_OllamaBotControlBatchSize = sConfigMgr->GetOption<uint32>("OllamaBotControl.Batch.Size", 5);
+    g_OllamaBotControlBatchCellSize = sConfigMgr->GetOption<float>("OllamaBotControl.Batch.CellSize", 60.0f);
+    g_EnableOllamaBotControlPlans = sConfigMgr->GetOption<bool>("OllamaBotControl.Plan.Enable", true);
+    g_OllamaBotControlPlanMaxSteps = sConfigMgr->GetOption<uint32>("OllamaBotControl.Plan.MaxSteps", 4);
+    g_OllamaBotControlPlanArrivalDistance = sConfigMgr->GetOption<float>("OllamaBotControl.Plan.ArrivalDistance", 3.0f);
+    g_OllamaBotControlPlanStepTimeoutSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Plan.StepTimeoutSeconds", 30);
+    g_EnableOllamaBotControlReflexes = sConfigMgr->GetOption<bool>("OllamaBotControl.Reflex.Enable", true);
+    g_EnableOllamaBotControlReflexFightBack = sConfigMgr->GetOption<bool>("OllamaBotControl.Reflex.FightBack", true);
+    g_EnableOllamaBotControlReflexTurnIn = sConfigMgr->GetOption<bool>("OllamaBotControl.Reflex.TurnInQuest", true);
+    g_EnableOllamaBotControlReflexLoot = sConfigMgr->GetOption<bool>("OllamaBotControl.Reflex.Loot", true);
+    g_OllamaBotControlReflexLootRange = sConfigMgr->GetOption<float>("OllamaBotControl.Reflex.LootRange", 15.0f);
+    g_EnableOllamaBotControlHybrid = sConfigMgr->GetOption<bool>("OllamaBotControl.Hybrid.Enable", false);
+    g_OllamaBotControlHybridGoalSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Hybrid.GoalSeconds", 120);
+    g_EnableOllamaBotControlPrefetch = sConfigMgr->GetOption<bool>("OllamaBotControl.Prefetch.Enable", false);
+    g_OllamaBotControlPrefetchMinDistance = sConfigMgr->GetOption<float>("OllamaBotControl.Prefetch.MinDistance", 40.0f);
+    g_OllamaBotControlPrefetchTolerance = sConfigMgr->GetOption<float>("OllamaBotControl.Prefetch.Tolerance", 8.0f);
+    g_EnableOllamaBotControlWake = sConfigMgr->GetOption<bool>("OllamaBotControl.Wake.Enable", true);
+    g_OllamaBotControlWakeFallbackSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Wake.FallbackSeconds", 20);
+    g_OllamaBotControlContinuationTimeoutSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Continuation.TimeoutSeconds", 20);
+    g_OllamaBotControlPathCacheSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.PathCache.Seconds", 10);
+    g_OllamaBotControlPathWorkers = sConfigMgr->GetOption<uint32>("OllamaBotControl.PathWorkers", 2);
+    g_OllamaBotControlChatQueueSize = sConfigMgr->GetOption<uint32>("OllamaBotControl.Chat.QueueSize", 8);
+    g_OllamaBotControlChatSenderMessagesPerMinute = sConfigMgr->GetOption<uint32>("OllamaBotControl.Chat.SenderMessagesPerMinute", 12);
+    g_OllamaBotControlChatMaxBytes = sConfigMgr->GetOption<uint32>("OllamaBotControl.Chat.MaxBytes", 65536);
+    g_EnableOllamaBotControlChatCancelInFlight = sConfigMgr->GetOption<bool>("OllamaBotControl.Chat.CancelInFlight", true);
+    g_EnableOllamaBotControlChatFastPath = sConfigMgr->GetOption<bool>("OllamaBotControl.Chat.FastPath", true);
+    g_OllamaBotControlEnrollNames = SplitConfigList(sConfigMgr->GetOption<std::string>("OllamaBotControl.Enroll.Names", "Ollamatest"));
+    g_EnableOllamaBotControlMemory = sConfigMgr->GetOption<bool>("OllamaBotControl.Memory.Enable", true);
+    g_OllamaBotControlMemoryFlushSeconds = sConfigMgr->GetOption<uint32>("OllamaBotControl.Memory.FlushSeconds", 5);
+    g_OllamaBotControlStreamingStatsGraceMs = sConfigMgr->GetOption<uint32>("OllamaBotControl.Streaming.StatsGraceMs", 250);
+
+    sBotBuddyEndpointPool->Load(SplitConfigList(g_OllamaBotControlUrl));
+    sBotBuddyEnrollment->Load();
 }
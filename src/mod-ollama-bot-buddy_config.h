@@ -1,12 +1,65 @@
 #pragma once
 #include "ScriptMgr.h"
 #include <string>
+#include <vector>
 
 extern bool g_EnableOllamaBotControl;
 extern std::string g_OllamaBotControlUrl;
 extern std::string g_OllamaBotControlModel;
 extern bool g_EnableOllamaBotBuddyDebug;
 extern bool g_EnableBotBuddyAddon;
+extern bool g_EnableOllamaBotControlStreaming;
+extern bool g_EnableOllamaBotControlStructuredOutput;
+extern uint32 g_OllamaBotControlNumPredict;
+extern std::vector<std::string> g_OllamaBotControlStopSequences;
+extern float g_OllamaBotControlTemperature;
+extern bool g_EnableOllamaBotControlAutoNumPredict;
+extern uint32 g_OllamaBotControlNumPredictPercentile;
+extern uint32 g_OllamaBotControlNumPredictWindow;
+extern uint32 g_OllamaBotControlMaxReasoningLength;
+extern uint32 g_OllamaBotControlMaxSayLength;
+extern uint32 g_OllamaBotControlConnectTimeoutMs;
+extern uint32 g_OllamaBotControlRequestTimeoutMs;
+extern bool g_EnableOllamaBotControlCircuitBreaker;
+extern uint32 g_OllamaBotControlBreakerFailureThreshold;
+extern uint32 g_OllamaBotControlBreakerLatencyThresholdMs;
+extern uint32 g_OllamaBotControlBreakerLatencyWindow;
+extern uint32 g_OllamaBotControlBreakerOpenSeconds;
+extern uint32 g_OllamaBotControlEndpointStickySlack;
+extern uint32 g_OllamaBotControlEndpointFailureThreshold;
+extern uint32 g_OllamaBotControlEndpointRetrySeconds;
+extern uint32 g_OllamaBotControlEndpointHealthCheckSeconds;
+extern bool g_EnableOllamaBotControlBatching;
+extern uint32 g_OllamaBotControlBatchSize;
+extern float g_OllamaBotControlBatchCellSize;
+extern bool g_EnableOllamaBotControlPlans;
+extern uint32 g_OllamaBotControlPlanMaxSteps;
+extern float g_OllamaBotControlPlanArrivalDistance;
+extern uint32 g_OllamaBotControlPlanStepTimeoutSeconds;
+extern bool g_EnableOllamaBotControlReflexes;
+extern bool g_EnableOllamaBotControlReflexFightBack;
+extern bool g_EnableOllamaBotControlReflexTurnIn;
+extern bool g_EnableOllamaBotControlReflexLoot;
+extern float g_OllamaBotControlReflexLootRange;
+extern bool g_EnableOllamaBotControlHybrid;
+extern uint32 g_OllamaBotControlHybridGoalSeconds;
+extern bool g_EnableOllamaBotControlPrefetch;
+extern float g_OllamaBotControlPrefetchMinDistance;
+extern float g_OllamaBotControlPrefetchTolerance;
+extern bool g_EnableOllamaBotControlWake;
+extern uint32 g_OllamaBotControlWakeFallbackSeconds;
+extern uint32 g_OllamaBotControlContinuationTimeoutSeconds;
+extern uint32 g_OllamaBotControlPathCacheSeconds;
+extern uint32 g_OllamaBotControlPathWorkers;
+extern uint32 g_OllamaBotControlChatQueueSize;
+extern uint32 g_OllamaBotControlChatSenderMessagesPerMinute;
+extern uint32 g_OllamaBotControlChatMaxBytes;
+extern bool g_EnableOllamaBotControlChatCancelInFlight;
+extern bool g_EnableOllamaBotControlChatFastPath;
+extern std::vector<std::string> g_OllamaBotControlEnrollNames;
+extern bool g_EnableOllamaBotControlMemory;
+extern uint32 g_OllamaBotControlMemoryFlushSeconds;
+extern uint32 g_OllamaBotControlStreamingStatsGraceMs;
 
 class OllamaBotControlConfigWorldScript : public WorldScript
 {
@@ -0,0 +1,234 @@
+#include "mod-ollama-bot-buddy_endpoints.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "Log.h"
+#include <algorithm>
+#include <thread>
+#include <curl/curl.h>
+#include <fmt/format.h>
+
+BotBuddyEndpointPool* BotBuddyEndpointPool::instance()
+{
+    static BotBuddyEndpointPool instance;
+    return &instance;
+}
+
+// "http://host:11434/api/generate" -> "http://host:11434/api/tags"
+static std::string MakeHealthUrl(const std::string& url)
+{
+    size_t scheme = url.find("://");
+    size_t pathStart = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+    return (pathStart == std::string::npos ? url : url.substr(0, pathStart)) + "/api/tags";
+}
+
+void BotBuddyEndpointPool::Load(const std::vector<std::string>& entries)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _endpoints.clear();
+    _stickyByBot.clear();
+
+    for (const std::string& entry : entries)
+    {
+        BotBuddyEndpoint endpoint;
+        size_t sep = entry.find(';');
+        endpoint.url = entry.substr(0, sep);
+        if (sep != std::string::npos)
+        {
+            try
+            {
+                endpoint.weight = std::max(1, std::stoi(entry.substr(sep + 1)));
+            }
+            catch (const std::exception&)
+            {
+                LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid weight in endpoint '{}', using 1", entry);
+            }
+        }
+        endpoint.healthUrl = MakeHealthUrl(endpoint.url);
+        _endpoints.push_back(endpoint);
+
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Ollama endpoint {} (weight {})", endpoint.url, endpoint.weight);
+    }
+}
+
+double BotBuddyEndpointPool::GetLoad(const BotBuddyEndpoint& endpoint) const
+{
+    return double(endpoint.outstanding) / endpoint.weight;
+}
+
+int BotBuddyEndpointPool::Acquire(uint64_t botGuid, std::string& url)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_endpoints.empty()) return -1;
+
+    auto now = std::chrono::steady_clock::now();
+
+    // Unhealthy nodes come back into rotation once their retry time passes
+    for (BotBuddyEndpoint& endpoint : _endpoints)
+    {
+        if (!endpoint.healthy && now >= endpoint.retryAt)
+        {
+            endpoint.healthy = true;
+            endpoint.consecutiveFailures = 0;
+        }
+    }
+
+    int best = -1;
+    for (size_t i = 0; i < _endpoints.size(); ++i)
+    {
+        if (!_endpoints[i].healthy) continue;
+        if (best < 0 || GetLoad(_endpoints[i]) < GetLoad(_endpoints[best]))
+            best = int(i);
+    }
+
+    // Everything is down: keep sending to the least loaded node and let the
+    // circuit breaker decide when to stop
+    if (best < 0)
+    {
+        best = 0;
+        for (size_t i = 1; i < _endpoints.size(); ++i)
+            if (GetLoad(_endpoints[i]) < GetLoad(_endpoints[best]))
+                best = int(i);
+    }
+
+    int chosen = best;
+    auto sticky = _stickyByBot.find(botGuid);
+    if (sticky != _stickyByBot.end() && sticky->second < int(_endpoints.size()))
+    {
+        BotBuddyEndpoint const& pinned = _endpoints[sticky->second];
+        if (pinned.healthy && GetLoad(pinned) <= GetLoad(_endpoints[best]) + g_OllamaBotControlEndpointStickySlack)
+            chosen = sticky->second;
+    }
+
+    _stickyByBot[botGuid] = chosen;
+    BotBuddyEndpoint& endpoint = _endpoints[chosen];
+    endpoint.outstanding++;
+    endpoint.requests++;
+    url = endpoint.url;
+    return chosen;
+}
+
+void BotBuddyEndpointPool::Release(int index, bool success)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (index < 0 || index >= int(_endpoints.size())) return;
+
+    BotBuddyEndpoint& endpoint = _endpoints[index];
+    if (endpoint.outstanding) endpoint.outstanding--;
+
+    if (success)
+    {
+        endpoint.consecutiveFailures = 0;
+        return;
+    }
+
+    endpoint.failures++;
+    if (++endpoint.consecutiveFailures >= g_OllamaBotControlEndpointFailureThreshold && endpoint.healthy)
+    {
+        endpoint.healthy = false;
+        endpoint.retryAt = std::chrono::steady_clock::now() + std::chrono::seconds(g_OllamaBotControlEndpointRetrySeconds);
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] Endpoint {} marked unhealthy after {} failures", endpoint.url, endpoint.consecutiveFailures);
+    }
+}
+
+static size_t DiscardCallback(void* /*contents*/, size_t size, size_t nmemb, void* /*userp*/)
+{
+    return size * nmemb;
+}
+
+void BotBuddyEndpointPool::RunHealthChecks()
+{
+    std::vector<std::string> healthUrls;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        for (BotBuddyEndpoint const& endpoint : _endpoints)
+            healthUrls.push_back(endpoint.healthUrl);
+    }
+
+    std::vector<bool> results;
+    for (const std::string& healthUrl : healthUrls)
+    {
+        bool ok = false;
+        if (CURL* curl = curl_easy_init())
+        {
+            curl_easy_setopt(curl, CURLOPT_URL, healthUrl.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, DiscardCallback);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, long(g_OllamaBotControlConnectTimeoutMs));
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, long(g_OllamaBotControlConnectTimeoutMs * 2));
+
+            long httpStatus = 0;
+            if (curl_easy_perform(curl) == CURLE_OK)
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+            ok = httpStatus >= 200 && httpStatus < 300;
+            curl_easy_cleanup(curl);
+        }
+        results.push_back(ok);
+    }
+
+    std::lock_guard<std::mutex> guard(_lock);
+    // The list may have been reloaded while we were checking
+    if (results.size() != _endpoints.size()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        BotBuddyEndpoint& endpoint = _endpoints[i];
+        if (results[i] && !endpoint.healthy)
+        {
+            endpoint.healthy = true;
+            endpoint.consecutiveFailures = 0;
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Endpoint {} passed its health check", endpoint.url);
+        }
+        else if (!results[i] && endpoint.healthy)
+        {
+            endpoint.healthy = false;
+            endpoint.retryAt = now + std::chrono::seconds(g_OllamaBotControlEndpointRetrySeconds);
+            LOG_ERROR("server.loading", "[OllamaBotBuddy] Endpoint {} failed its health check", endpoint.url);
+        }
+    }
+}
+
+void BotBuddyEndpointPool::Update()
+{
+    if (!g_OllamaBotControlEndpointHealthCheckSeconds) return;
+
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        // A single node has nowhere to fail over to, so probing it buys nothing
+        if (_endpoints.size() < 2 || now < _nextHealthCheck) return;
+        _nextHealthCheck = now + std::chrono::seconds(g_OllamaBotControlEndpointHealthCheckSeconds);
+    }
+
+    bool expected = false;
+    if (!_healthCheckRunning.compare_exchange_strong(expected, true)) return;
+
+    std::thread([this]() {
+        RunHealthChecks();
+        _healthCheckRunning = false;
+    }).detach();
+}
+
+void BotBuddyEndpointPool::Forget(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _stickyByBot.erase(botGuid);
+}
+
+size_t BotBuddyEndpointPool::GetEndpointCount()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _endpoints.size();
+}
+
+std::vector<std::string> BotBuddyEndpointPool::GetSummary()
+{
+    std::vector<std::string> lines;
+    std::lock_guard<std::mutex> guard(_lock);
+    for (BotBuddyEndpoint const& endpoint : _endpoints)
+    {
+        lines.push_back(fmt::format("{} weight={} {} outstanding={} requests={} failures={}",
+            endpoint.url, endpoint.weight, endpoint.healthy ? "healthy" : "UNHEALTHY",
+            endpoint.outstanding, endpoint.requests, endpoint.failures));
+    }
+    return lines;
+}
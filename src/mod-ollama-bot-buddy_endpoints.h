@@ -0,0 +1,58 @@
+#pragma once
+#include "Define.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One Ollama node from OllamaBotControl.Url ("url" or "url;weight")
+struct BotBuddyEndpoint
+{
+    std::string url;
+    std::string healthUrl;
+    uint32 weight = 1;
+    uint32 outstanding = 0;
+    uint32 consecutiveFailures = 0;
+    bool healthy = true;
+    std::chrono::steady_clock::time_point retryAt;
+    uint64 requests = 0;
+    uint64 failures = 0;
+};
+
+// Spreads requests over several Ollama nodes. Each bot sticks to the node that
+// served it last so its KV cache stays warm there, unless that node is
+// unhealthy or noticeably busier than the least loaded one (outstanding / weight).
+class BotBuddyEndpointPool
+{
+public:
+    static BotBuddyEndpointPool* instance();
+
+    void Load(const std::vector<std::string>& entries);
+
+    // Returns -1 when no endpoint is configured. Every successful Acquire must be
+    // paired with a Release.
+    int Acquire(uint64_t botGuid, std::string& url);
+    void Release(int index, bool success);
+    // Drops the bot's sticky endpoint; it is picked afresh on its next request
+    void Forget(uint64_t botGuid);
+
+    // Called from the world tick; starts a background health check when due
+    void Update();
+
+    size_t GetEndpointCount();
+    std::vector<std::string> GetSummary();
+
+private:
+    double GetLoad(const BotBuddyEndpoint& endpoint) const;
+    void RunHealthChecks();
+
+    std::mutex _lock;
+    std::vector<BotBuddyEndpoint> _endpoints;
+    std::unordered_map<uint64_t, int> _stickyByBot;
+    std::chrono::steady_clock::time_point _nextHealthCheck;
+    std::atomic<bool> _healthCheckRunning { false };
+};
+
+#define sBotBuddyEndpointPool BotBuddyEndpointPool::instance()
@@ -0,0 +1,105 @@
+#include "mod-ollama-bot-buddy_enrollment.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "DatabaseEnv.h"
+#include "ObjectAccessor.h"
+#include "Player.h"
+#include "Log.h"
+#include <algorithm>
+#include <cctype>
+
+static std::string ToLowerName(std::string name)
+{
+    for (char& c : name)
+        c = char(std::tolower(uint8(c)));
+    return name;
+}
+
+BotBuddyEnrollment* BotBuddyEnrollment::instance()
+{
+    static BotBuddyEnrollment instance;
+    return &instance;
+}
+
+void BotBuddyEnrollment::Load()
+{
+    _names.clear();
+    for (std::string const& name : g_OllamaBotControlEnrollNames)
+        _names.insert(ToLowerName(name));
+
+    _guids.clear();
+    if (QueryResult result = CharacterDatabase.Query("SELECT guid FROM mod_ollama_bot_buddy_enrollment"))
+    {
+        do
+        {
+            _guids.insert(result->Fetch()[0].Get<uint32>());
+        } while (result->NextRow());
+    }
+
+    LOG_INFO("server.loading", "[OllamaBotBuddy] Enrolled bots: {} by name, {} from the database.", _names.size(), _guids.size());
+}
+
+bool BotBuddyEnrollment::IsEnrolled(Player* player) const
+{
+    return _guids.count(player->GetGUID().GetCounter()) || _names.count(ToLowerName(player->GetName()));
+}
+
+bool BotBuddyEnrollment::Enroll(ObjectGuid guid)
+{
+    if (!_guids.insert(guid.GetCounter()).second) return false;
+
+    CharacterDatabase.Execute("REPLACE INTO mod_ollama_bot_buddy_enrollment (guid) VALUES ({})", guid.GetCounter());
+
+    if (ObjectAccessor::FindConnectedPlayer(guid))
+        SetOnline(guid.GetRawValue(), true);
+    return true;
+}
+
+bool BotBuddyEnrollment::Unenroll(ObjectGuid guid)
+{
+    if (!_guids.erase(guid.GetCounter())) return false;
+
+    CharacterDatabase.Execute("DELETE FROM mod_ollama_bot_buddy_enrollment WHERE guid = {}", guid.GetCounter());
+
+    Player* player = ObjectAccessor::FindConnectedPlayer(guid);
+    if (player && !IsEnrolled(player))
+    {
+        SetOnline(guid.GetRawValue(), false);
+        ReleaseBuddyBot(player);
+    }
+    return true;
+}
+
+void BotBuddyEnrollment::OnLogin(Player* player)
+{
+    if (IsEnrolled(player))
+        SetOnline(player->GetGUID().GetRawValue(), true);
+}
+
+void BotBuddyEnrollment::OnLogout(uint64_t botGuid)
+{
+    SetOnline(botGuid, false);
+}
+
+void BotBuddyEnrollment::SetOnline(uint64_t botGuid, bool online)
+{
+    auto it = std::find(_online.begin(), _online.end(), botGuid);
+    if (online && it == _online.end())
+        _online.push_back(botGuid);
+    else if (!online && it != _online.end())
+    {
+        // Order does not matter to the loop
+        *it = _online.back();
+        _online.pop_back();
+    }
+}
+
+void BotBuddyEnrollmentScript::OnPlayerLogin(Player* player)
+{
+    sBotBuddyEnrollment->OnLogin(player);
+}
+
+void BotBuddyEnrollmentScript::OnPlayerLogout(Player* player)
+{
+    sBotBuddyEnrollment->OnLogout(player->GetGUID().GetRawValue());
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "ScriptMgr.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Which bots the LLM controls. A bot is enrolled when its name is in
+// OllamaBotControl.Enroll.Names or its GUID is in the
+// mod_ollama_bot_buddy_enrollment table (filled by `.buddy enroll`). The
+// decision loop only walks the enrolled bots that are online, so its cost
+// does not grow with the number of players on the realm. World thread only.
+class BotBuddyEnrollment
+{
+public:
+    static BotBuddyEnrollment* instance();
+
+    // Startup: reads the config list and the table
+    void Load();
+
+    bool IsEnrolled(Player* player) const;
+
+    // GM command; persisted. False when the bot already was enrolled.
+    bool Enroll(ObjectGuid guid);
+    // False when the bot is not in the table (it may still be enrolled by name)
+    bool Unenroll(ObjectGuid guid);
+
+    void OnLogin(Player* player);
+    void OnLogout(uint64_t botGuid);
+
+    // Not to be changed while iterating; only logins, logouts and GM commands do
+    std::vector<uint64_t> const& GetOnline() const { return _online; }
+    size_t GetTableCount() const { return _guids.size(); }
+    size_t GetNameCount() const { return _names.size(); }
+
+private:
+    void SetOnline(uint64_t botGuid, bool online);
+
+    std::unordered_set<uint32> _guids;       // character low GUIDs from the table
+    std::unordered_set<std::string> _names;  // lowercased, from the config
+    std::vector<uint64_t> _online;
+};
+
+#define sBotBuddyEnrollment BotBuddyEnrollment::instance()
+
+class BotBuddyEnrollmentScript : public PlayerScript
+{
+public:
+    BotBuddyEnrollmentScript() : PlayerScript("BotBuddyEnrollmentScript") {}
+
+    void OnPlayerLogin(Player* player) override;
+    void OnPlayerLogout(Player* player) override;
+};
@@ -0,0 +1,120 @@
+#include "mod-ollama-bot-buddy_generation.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "Log.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+// Tuning never shrinks num_predict below this, so a short run of tiny replies
+// cannot starve the next decision
+static constexpr uint32 MIN_TUNED_NUM_PREDICT = 48;
+static constexpr uint32 MIN_SAMPLES_FOR_TUNING = 8;
+
+BotBuddyGenerationTuner* BotBuddyGenerationTuner::instance()
+{
+    static BotBuddyGenerationTuner instance;
+    return &instance;
+}
+
+uint32 BotBuddyGenerationTuner::Percentile(std::vector<uint32> values, uint32 percentile)
+{
+    if (values.empty()) return 0;
+    size_t rank = (values.size() - 1) * std::min<uint32>(percentile, 100) / 100;
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+uint32 BotBuddyGenerationTuner::TunedNumPredict(const Samples& samples) const
+{
+    uint32 ceiling = g_OllamaBotControlNumPredict;
+    if (!g_EnableOllamaBotControlAutoNumPredict || samples.window.size() < MIN_SAMPLES_FOR_TUNING)
+        return ceiling;
+
+    uint32 observed = Percentile(std::vector<uint32>(samples.window.begin(), samples.window.end()),
+        g_OllamaBotControlNumPredictPercentile);
+
+    // 25% headroom over the percentile keeps the tail from being cut mid-object
+    uint32 tuned = std::max(MIN_TUNED_NUM_PREDICT, observed + observed / 4);
+    return ceiling > 0 ? std::min(tuned, ceiling) : tuned;
+}
+
+OllamaGenerationOptions BotBuddyGenerationTuner::GetOptionsFor(uint64_t botGuid)
+{
+    OllamaGenerationOptions options;
+    options.temperature = g_OllamaBotControlTemperature;
+    options.stop = g_OllamaBotControlStopSequences;
+    options.numPredict = g_OllamaBotControlNumPredict;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    auto last = _lastTypeByBot.find(botGuid);
+    if (last == _lastTypeByBot.end()) return options;
+
+    auto samples = _samplesByType.find(last->second);
+    if (samples != _samplesByType.end())
+        options.numPredict = TunedNumPredict(samples->second);
+
+    return options;
+}
+
+void BotBuddyGenerationTuner::Record(uint64_t botGuid, const std::string& commandType, uint32 generatedTokens)
+{
+    if (commandType.empty())
+    {
+        // No usable command came back, possibly cut off by a tuned limit that was
+        // too tight; fall back to the ceiling for this bot's next request
+        std::lock_guard<std::mutex> guard(_lock);
+        _lastTypeByBot.erase(botGuid);
+        return;
+    }
+
+    if (!generatedTokens) return;
+
+    uint64_t count = 0;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        Samples& samples = _samplesByType[commandType];
+        samples.window.push_back(generatedTokens);
+        while (samples.window.size() > std::max<uint32>(g_OllamaBotControlNumPredictWindow, 1))
+            samples.window.pop_front();
+        samples.count++;
+        samples.totalTokens += generatedTokens;
+        samples.maxTokens = std::max(samples.maxTokens, generatedTokens);
+        _lastTypeByBot[botGuid] = commandType;
+        count = samples.count;
+    }
+
+    if (g_EnableOllamaBotBuddyDebug && count % 50 == 0)
+    {
+        for (const auto& line : GetDistributionSummary())
+            LOG_INFO("server.loading", "[OllamaBotBuddy] {}", line);
+    }
+}
+
+void BotBuddyGenerationTuner::Forget(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _lastTypeByBot.erase(botGuid);
+}
+
+std::vector<std::string> BotBuddyGenerationTuner::GetDistributionSummary()
+{
+    std::vector<std::string> lines;
+    std::lock_guard<std::mutex> guard(_lock);
+
+    for (const auto& [type, samples] : _samplesByType)
+    {
+        std::vector<uint32> window(samples.window.begin(), samples.window.end());
+        uint32 tuned = TunedNumPredict(samples);
+        double mean = samples.count ? double(samples.totalTokens) / samples.count : 0.0;
+
+        // Tokens a fixed ceiling would have allowed but the tuned limit no longer reserves
+        uint32 ceiling = g_OllamaBotControlNumPredict;
+        uint32 recovered = ceiling > tuned ? ceiling - tuned : 0;
+
+        lines.push_back(fmt::format(
+            "eval_count {}: n={} mean={:.1f} p50={} p95={} p99={} max={} num_predict={} (ceiling {}, {} tokens/request recovered)",
+            type, samples.count, mean,
+            Percentile(window, 50), Percentile(window, 95), Percentile(window, 99),
+            samples.maxTokens, tuned, ceiling, recovered));
+    }
+    return lines;
+}
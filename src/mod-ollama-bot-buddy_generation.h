@@ -0,0 +1,61 @@
+#pragma once
+#include "Define.h"
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Which JSON shape the reply is constrained to
+enum class OllamaReplyFormat
+{
+    Command,    // {command, reasoning, say}
+    Batch,      // {"commands":[...]} for several bots
+    Goal        // {goal, reasoning, say} in hybrid mode
+};
+
+// Per-request generation options sent in the "options" object of /api/generate
+struct OllamaGenerationOptions
+{
+    uint32 numPredict = 0;      // 0 leaves the model default in place
+    float temperature = -1.0f;  // negative leaves the model default in place
+    std::vector<std::string> stop;
+    OllamaReplyFormat replyFormat = OllamaReplyFormat::Command;
+    bool cancellable = false;   // a player message may abort it, see CancelOllamaRequest
+    std::chrono::steady_clock::time_point queuedAt {};  // set when a decision is dispatched, for the queue wait metric
+};
+
+// Picks num_predict per decision from a rolling percentile of how many tokens
+// replies of the expected command type actually used, and keeps the observed
+// eval_count distribution around for reporting.
+class BotBuddyGenerationTuner
+{
+public:
+    static BotBuddyGenerationTuner* instance();
+
+    // The expected command type is whatever this bot chose last time
+    OllamaGenerationOptions GetOptionsFor(uint64_t botGuid);
+    void Record(uint64_t botGuid, const std::string& commandType, uint32 generatedTokens);
+    void Forget(uint64_t botGuid);
+
+    std::vector<std::string> GetDistributionSummary();
+
+private:
+    struct Samples
+    {
+        std::deque<uint32> window;
+        uint64_t count = 0;
+        uint64_t totalTokens = 0;
+        uint32 maxTokens = 0;
+    };
+
+    uint32 TunedNumPredict(const Samples& samples) const;
+    static uint32 Percentile(std::vector<uint32> values, uint32 percentile);
+
+    std::mutex _lock;
+    std::unordered_map<std::string, Samples> _samplesByType;
+    std::unordered_map<uint64_t, std::string> _lastTypeByBot;
+};
+
+#define sBotBuddyGenerationTuner BotBuddyGenerationTuner::instance()
@@ -0,0 +1,139 @@
+#include "mod-ollama-bot-buddy_gmcommands.h"
+#include "mod-ollama-bot-buddy_enrollment.h"
+#include "mod-ollama-bot-buddy_state.h"
+#include "mod-ollama-bot-buddy_metrics.h"
+#include "mod-ollama-bot-buddy_llm.h"
+#include "mod-ollama-bot-buddy_endpoints.h"
+#include "mod-ollama-bot-buddy_handler.h"
+#include "mod-ollama-bot-buddy_chatcommands.h"
+#include "mod-ollama-bot-buddy_plan.h"
+#include "mod-ollama-bot-buddy_reflex.h"
+#include "mod-ollama-bot-buddy_goals.h"
+#include "mod-ollama-bot-buddy_prefetch.h"
+#include "mod-ollama-bot-buddy_wake.h"
+#include "mod-ollama-bot-buddy_pathing.h"
+#include "mod-ollama-bot-buddy_memory.h"
+#include "Chat.h"
+#include "Language.h"
+#include "ObjectAccessor.h"
+#include "Player.h"
+
+using namespace Acore::ChatCommands;
+
+// Without a name the command applies to the selected player
+static Optional<PlayerIdentifier> ResolveTarget(ChatHandler* handler, Optional<PlayerIdentifier> target)
+{
+    if (!target)
+        target = PlayerIdentifier::FromTargetOrSelf(handler);
+    if (!target)
+    {
+        handler->SendSysMessage(LANG_PLAYER_NOT_FOUND);
+        handler->SetSentErrorMessage(true);
+    }
+    return target;
+}
+
+static bool HandleBuddyEnrollCommand(ChatHandler* handler, Optional<PlayerIdentifier> target)
+{
+    target = ResolveTarget(handler, target);
+    if (!target) return false;
+
+    if (!sBotBuddyEnrollment->Enroll(target->GetGUID()))
+    {
+        handler->PSendSysMessage("{} is already enrolled.", target->GetName());
+        return true;
+    }
+
+    handler->PSendSysMessage("{} is now controlled by the LLM.", target->GetName());
+    return true;
+}
+
+static bool HandleBuddyUnenrollCommand(ChatHandler* handler, Optional<PlayerIdentifier> target)
+{
+    target = ResolveTarget(handler, target);
+    if (!target) return false;
+
+    if (!sBotBuddyEnrollment->Unenroll(target->GetGUID()))
+    {
+        handler->PSendSysMessage("{} was not enrolled with .buddy enroll; bots listed in OllamaBotControl.Enroll.Names stay enrolled.", target->GetName());
+        return true;
+    }
+
+    handler->PSendSysMessage("{} is back on its Playerbot strategies.", target->GetName());
+    return true;
+}
+
+static bool HandleBuddyListCommand(ChatHandler* handler)
+{
+    handler->PSendSysMessage("Enrolled: {} by name, {} by .buddy enroll. Online: {}, controlled: {}.",
+        sBotBuddyEnrollment->GetNameCount(), sBotBuddyEnrollment->GetTableCount(),
+        sBotBuddyEnrollment->GetOnline().size(), sBotBuddyStates->GetCount());
+
+    for (uint64_t guid : sBotBuddyEnrollment->GetOnline())
+    {
+        if (Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(guid)))
+        {
+            handler->PSendSysMessage("  {} (level {}){}", bot->GetName(), bot->GetLevel(),
+                sBotBuddyStates->Find(guid) ? "" : ", waiting for its Playerbot AI");
+        }
+    }
+    return true;
+}
+
+static bool HandleBuddyStatsCommand(ChatHandler* handler)
+{
+    uint32 waiting = 0;
+    for (uint64_t guid : sBotBuddyEnrollment->GetOnline())
+    {
+        BotBuddyState* state = sBotBuddyStates->Find(guid);
+        if (state && state->busy)
+            waiting++;
+    }
+    handler->PSendSysMessage("Controlled bots: {}, waiting on a decision: {}.", sBotBuddyStates->GetCount(), waiting);
+
+    // Lines are sent as they are; they can contain braces from commands and JSON
+    auto send = [handler](std::vector<std::string> const& lines) {
+        for (std::string const& line : lines)
+            handler->SendSysMessage(line);
+    };
+
+    send(sBotBuddyMetrics->GetSummary());
+    send(sBotBuddyOllamaUsage->GetModelSummary());
+    for (uint64_t guid : sBotBuddyEnrollment->GetOnline())
+    {
+        std::string usage = sBotBuddyOllamaUsage->GetBotSummary(guid);
+        Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(guid));
+        if (bot && !usage.empty())
+            handler->SendSysMessage(bot->GetName() + ": " + usage);
+    }
+    send(sBotBuddyCircuitBreaker->GetSummary());
+    send(sBotBuddyEndpointPool->GetSummary());
+    send(sBotBuddyGenerationTuner->GetDistributionSummary());
+    send(sBotBuddyChatInbox->GetSummary());
+    send(sBotBuddyChatCommands->GetSummary());
+    send(sBotBuddyPlanExecutor->GetSummary());
+    send(sBotBuddyReflexEngine->GetSummary());
+    send(sBotBuddyGoalManager->GetSummary());
+    send(sBotBuddyPrefetcher->GetSummary());
+    send(sBotBuddyWakeScheduler->GetSummary());
+    send(sBotBuddyPathWorkers->GetSummary());
+    send(sBotBuddyMemory->GetSummary());
+    return true;
+}
+
+ChatCommandTable BotBuddyCommandScript::GetCommands() const
+{
+    static ChatCommandTable buddyCommandTable =
+    {
+        { "enroll",   HandleBuddyEnrollCommand,   SEC_GAMEMASTER, Console::Yes },
+        { "unenroll", HandleBuddyUnenrollCommand, SEC_GAMEMASTER, Console::Yes },
+        { "list",     HandleBuddyListCommand,     SEC_GAMEMASTER, Console::Yes },
+        { "stats",    HandleBuddyStatsCommand,    SEC_GAMEMASTER, Console::Yes },
+    };
+
+    static ChatCommandTable commandTable =
+    {
+        { "buddy", buddyCommandTable },
+    };
+    return commandTable;
+}
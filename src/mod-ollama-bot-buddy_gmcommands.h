@@ -0,0 +1,13 @@
+#pragma once
+#include "ScriptMgr.h"
+#include "ChatCommand.h"
+
+// `.buddy` GM commands: enroll and unenroll bots, list the enrolled ones and
+// report where decision time goes
+class BotBuddyCommandScript : public CommandScript
+{
+public:
+    BotBuddyCommandScript() : CommandScript("BotBuddyCommandScript") {}
+
+    Acore::ChatCommands::ChatCommandTable GetCommands() const override;
+};
@@ -0,0 +1,194 @@
+#include "mod-ollama-bot-buddy_goals.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_api.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "mod-ollama-bot-buddy_handler.h"
+#include "Player.h"
+#include "PlayerbotAI.h"
+#include "Playerbots.h"
+#include "MoveSpline.h"
+#include "Log.h"
+#include <fmt/format.h>
+
+// Movement takes a moment to start after the command is issued
+static constexpr std::chrono::milliseconds TRAVEL_SETTLE_TIME { 1000 };
+
+// Non-combat strategy changes per goal. Combat and dead strategies stay at the
+// bot's defaults.
+struct BotBuddyGoalDef
+{
+    const char* type;
+    const char* strategies;
+};
+
+static BotBuddyGoalDef const BotBuddyGoalDefs[] =
+{
+    { "grind",   "+grind,-rpg,-quest,-travel,-follow" },
+    { "quest",   "+quest,+rpg,-grind,-follow" },
+    { "explore", "+rpg,+travel,-grind,-follow" },
+    { "follow",  "+follow,-grind,-rpg,-quest,-travel" },
+    { "go_to",   "-grind,-rpg,-quest,-travel,-follow" },
+};
+
+static BotBuddyGoalDef const* FindGoalDef(const std::string& type)
+{
+    for (BotBuddyGoalDef const& def : BotBuddyGoalDefs)
+        if (type == def.type)
+            return &def;
+    return nullptr;
+}
+
+std::vector<std::string> GetBotBuddyGoalTypes()
+{
+    std::vector<std::string> types;
+    for (BotBuddyGoalDef const& def : BotBuddyGoalDefs)
+        types.push_back(def.type);
+    return types;
+}
+
+BotBuddyGoalManager* BotBuddyGoalManager::instance()
+{
+    static BotBuddyGoalManager instance;
+    return &instance;
+}
+
+static bool HasDestination(const nlohmann::json& params)
+{
+    return params.is_object() && params.contains("x") && params.contains("y") && params.contains("z");
+}
+
+bool BotBuddyGoalManager::ApplyStrategies(Player* bot, const std::string& type)
+{
+    PlayerbotAI* ai = sPlayerbotsMgr->GetPlayerbotAI(bot);
+    BotBuddyGoalDef const* def = FindGoalDef(type);
+    if (!ai || !def) return false;
+
+    ai->ChangeStrategy(def->strategies, BOT_STATE_NON_COMBAT);
+    return true;
+}
+
+bool BotBuddyGoalManager::StartTravel(Player* bot, const nlohmann::json& params)
+{
+    // Same validation as an LLM move_to
+    BotControlCommand command;
+    if (!BuildBotControlCommand(bot, "move_to", params, command)) return false;
+
+    // Nothing non-combat may pull the bot off its path
+    ApplyStrategies(bot, "go_to");
+    return HandleBotControlCommand(bot, command);
+}
+
+bool BotBuddyGoalManager::Apply(Player* bot, const std::string& type, const nlohmann::json& params)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    _goals.erase(guid);
+
+    if (!FindGoalDef(type))
+    {
+        _rejected++;
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] Unknown goal type '{}'", type);
+        return false;
+    }
+
+    ActiveGoal goal;
+    goal.type = type;
+    goal.params = params;
+    goal.started = std::chrono::steady_clock::now();
+    goal.expires = goal.started + std::chrono::seconds(std::max<uint32>(g_OllamaBotControlHybridGoalSeconds, 1));
+
+    // go_to always travels; other goals travel first when given a spot
+    if (type == "go_to" || HasDestination(params))
+    {
+        if (!StartTravel(bot, params))
+        {
+            _rejected++;
+            return false;
+        }
+        goal.travelling = true;
+    }
+    else if (!ApplyStrategies(bot, type))
+    {
+        _rejected++;
+        return false;
+    }
+
+    _appliedByType[type]++;
+    _goals[guid] = std::move(goal);
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot {} goal: {}", bot->GetName(), type);
+    }
+    return true;
+}
+
+bool BotBuddyGoalManager::Update(Player* bot)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    auto it = _goals.find(guid);
+    if (it == _goals.end()) return false;
+
+    ActiveGoal& goal = it->second;
+    auto now = std::chrono::steady_clock::now();
+
+    if (now >= goal.expires)
+    {
+        _expired++;
+        _goals.erase(it);
+        return false;
+    }
+
+    if (HasPendingPlayerMessages(guid))
+    {
+        _interrupted++;
+        _goals.erase(it);
+        return false;
+    }
+
+    if (!goal.travelling) return true;
+
+    float x = goal.params.value("x", 0.0f);
+    float y = goal.params.value("y", 0.0f);
+    float z = goal.params.value("z", 0.0f);
+    if (bot->GetExactDist(x, y, z) <= g_OllamaBotControlPlanArrivalDistance)
+    {
+        goal.travelling = false;
+        if (goal.type == "go_to")
+        {
+            _reached++;
+            _goals.erase(it);
+            return false;
+        }
+        return ApplyStrategies(bot, goal.type);
+    }
+
+    // Native combat may have pulled the bot off its path; head out again once it is over
+    if (now - goal.started > TRAVEL_SETTLE_TIME && !bot->IsInCombat() && bot->movespline->Finalized())
+    {
+        if (!StartTravel(bot, goal.params))
+        {
+            _interrupted++;
+            _goals.erase(it);
+            return false;
+        }
+        goal.started = now;
+    }
+    return true;
+}
+
+void BotBuddyGoalManager::Clear(uint64_t botGuid)
+{
+    _goals.erase(botGuid);
+}
+
+std::vector<std::string> BotBuddyGoalManager::GetSummary() const
+{
+    std::string applied;
+    for (auto const& [type, count] : _appliedByType)
+        applied += fmt::format(" {}={}", type, count);
+
+    return {
+        fmt::format("goals: active={} expired={} reached={} interrupted={} rejected={} applied:{}",
+            _goals.size(), _expired, _reached, _interrupted, _rejected, applied.empty() ? " none" : applied)
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Define.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+
+// Goal types the LLM may pick in hybrid mode
+std::vector<std::string> GetBotBuddyGoalTypes();
+
+// Hybrid mode: the LLM picks a high-level goal (grind, quest, go to a place)
+// and the goal is mapped onto the bot's non-combat Playerbot strategies. Combat
+// strategies are never touched, so rotations keep running at tick rate.
+// A goal holds until it expires, its destination is reached, or a player
+// speaks to the bot. World thread only.
+class BotBuddyGoalManager
+{
+public:
+    static BotBuddyGoalManager* instance();
+
+    bool Apply(Player* bot, const std::string& type, const nlohmann::json& params);
+
+    // Returns true while the bot's current goal still holds
+    bool Update(Player* bot);
+    void Clear(uint64_t botGuid);
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    struct ActiveGoal
+    {
+        std::string type;
+        nlohmann::json params;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point expires;
+        bool travelling = false;  // still walking to params x/y/z before the goal proper starts
+    };
+
+    bool StartTravel(Player* bot, const nlohmann::json& params);
+    bool ApplyStrategies(Player* bot, const std::string& type);
+
+    std::unordered_map<uint64_t, ActiveGoal> _goals;
+    std::unordered_map<std::string, uint64> _appliedByType;
+    uint64 _rejected = 0;
+    uint64 _expired = 0;
+    uint64 _reached = 0;
+    uint64 _interrupted = 0;
+};
+
+#define sBotBuddyGoalManager BotBuddyGoalManager::instance()
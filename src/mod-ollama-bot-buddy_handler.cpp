@@ -1,17 +1,169 @@
 #include "mod-ollama-bot-buddy_handler.h"
+#include "mod-ollama-bot-buddy_chatcommands.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_llm.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "mod-ollama-bot-buddy_memory.h"
+#include "mod-ollama-bot-buddy_names.h"
+#include "mod-ollama-bot-buddy_state.h"
 #include "Log.h"
 #include "PlayerbotAI.h"
 #include "PlayerbotMgr.h"
 #include "ObjectAccessor.h"
-#include <mutex>
 #include <algorithm>
-#include <unordered_map>
-#include <deque>
-#include <chrono>
+#include <fmt/format.h>
 
-// Stores the last messages: [bot GUID][playerName] => pair<text, timestamp>
-std::unordered_map<uint64_t, std::deque<std::pair<std::string, std::string>>> botPlayerMessages;
-std::mutex botPlayerMessagesMutex;
+// Chat messages are capped at 255 characters by the client anyway
+static constexpr size_t CHAT_MAX_MESSAGE_LENGTH = 255;
+// Messages a sender may send in a row before the per-minute rate applies
+static constexpr float CHAT_SENDER_BURST = 3.0f;
+static constexpr size_t CHAT_MAX_TRACKED_SENDERS = 1024;
+
+BotBuddyChatInbox* BotBuddyChatInbox::instance()
+{
+    static BotBuddyChatInbox instance;
+    return &instance;
+}
+
+size_t BotBuddyChatInbox::GetSize(const BotBuddyChatMessage& message)
+{
+    return sizeof(BotBuddyChatMessage) + message.sender.size() + message.text.size();
+}
+
+void BotBuddyChatInbox::Close(uint64_t botGuid)
+{
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    if (!state) return;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    state->messages.ForEach([this](const BotBuddyChatMessage& message) { _bytes -= GetSize(message); });
+    while (!state->messages.Empty())
+        state->messages.PopFront();
+}
+
+bool BotBuddyChatInbox::AllowSender(uint64_t senderGuid)
+{
+    if (!g_OllamaBotControlChatSenderMessagesPerMinute) return true;
+
+    auto now = std::chrono::steady_clock::now();
+    float perSecond = g_OllamaBotControlChatSenderMessagesPerMinute / 60.0f;
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    // Forget senders whose bucket has refilled completely; they start full anyway
+    if (_senders.size() > CHAT_MAX_TRACKED_SENDERS)
+    {
+        for (auto it = _senders.begin(); it != _senders.end();)
+        {
+            float idle = std::chrono::duration<float>(now - it->second.refilled).count();
+            if (it->second.tokens + idle * perSecond >= CHAT_SENDER_BURST)
+                it = _senders.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    auto [it, inserted] = _senders.try_emplace(senderGuid);
+    SenderBudget& budget = it->second;
+    if (inserted)
+        budget.tokens = CHAT_SENDER_BURST;
+    else
+        budget.tokens = std::min(CHAT_SENDER_BURST, budget.tokens + std::chrono::duration<float>(now - budget.refilled).count() * perSecond);
+    budget.refilled = now;
+
+    if (budget.tokens < 1.0f)
+    {
+        _droppedRateLimited++;
+        return false;
+    }
+
+    budget.tokens -= 1.0f;
+    return true;
+}
+
+bool BotBuddyChatInbox::Push(uint64_t botGuid, const std::string& senderName, const std::string& text)
+{
+    BotBuddyChatMessage message { senderName, text.substr(0, CHAT_MAX_MESSAGE_LENGTH), 0 };
+    size_t size = GetSize(message);
+
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!state)
+    {
+        _droppedNotEnrolled++;
+        return false;
+    }
+
+    // A full ring makes room by dropping its oldest message
+    BotBuddyRing<BotBuddyChatMessage>& ring = state->messages;
+    size_t freed = ring.Full() ? GetSize(ring.Front()) : 0;
+    if (g_OllamaBotControlChatMaxBytes && _bytes - freed + size > g_OllamaBotControlChatMaxBytes)
+    {
+        _droppedMemoryCap++;
+        return false;
+    }
+
+    if (ring.Full())
+        _evicted++;
+
+    message.seq = ++state->messageSeq;
+    ring.Push(std::move(message));
+    _bytes += size - freed;
+    _accepted++;
+    return true;
+}
+
+std::vector<BotBuddyChatMessage> BotBuddyChatInbox::Peek(uint64_t botGuid)
+{
+    std::vector<BotBuddyChatMessage> messages;
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    if (!state) return messages;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    messages.reserve(state->messages.Size());
+    state->messages.ForEach([&messages](const BotBuddyChatMessage& message) { messages.push_back(message); });
+    return messages;
+}
+
+uint32 BotBuddyChatInbox::GetSeq(uint64_t botGuid)
+{
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    if (!state) return 0;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    return state->messageSeq;
+}
+
+void BotBuddyChatInbox::Acknowledge(uint64_t botGuid, uint32 seq)
+{
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    if (!state) return;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    while (!state->messages.Empty() && state->messages.Front().seq <= seq)
+        _bytes -= GetSize(state->messages.PopFront());
+}
+
+bool BotBuddyChatInbox::HasPending(uint64_t botGuid)
+{
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    return state && !state->messages.Empty();
+}
+
+std::vector<std::string> BotBuddyChatInbox::GetSummary()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return {
+        fmt::format("chat inboxes={} bytes={} accepted={} evicted={} dropped: not enrolled={} rate limited={} memory cap={}",
+            sBotBuddyStates->GetCount(), _bytes, _accepted, _evicted, _droppedNotEnrolled, _droppedRateLimited, _droppedMemoryCap)
+    };
+}
+
+bool HasPendingPlayerMessages(uint64_t botGuid)
+{
+    return sBotBuddyChatInbox->HasPending(botGuid);
+}
 
 void BotBuddyChatHandler::OnPlayerChat(Player* player, uint32_t type, uint32_t lang, std::string& msg)
 {
@@ -28,33 +180,47 @@ void BotBuddyChatHandler::OnPlayerChat(Player* player, uint32_t type, uint32_t l
 
 void BotBuddyChatHandler::ProcessChat(Player* player, uint32_t type, uint32_t lang, std::string& msg, Channel* channel)
 {
-    LOG_INFO("server.loading", "ProcessChat: sender={} type={} lang={} msg='{}' channel={}", 
-    player ? player->GetName() : "NULL", type, lang, msg, channel ? channel->GetName() : "nullptr");
-
     if (!player || msg.empty()) return;
     PlayerbotAI* senderAI = sPlayerbotsMgr->GetPlayerbotAI(player);
     if (senderAI && senderAI->IsBotAI()) return;
 
-    std::lock_guard<std::mutex> lock(botPlayerMessagesMutex);
+    // Scanned once against the enrolled names, before any lock is taken
+    std::vector<uint64_t> mentioned = sBotBuddyNameMatcher->FindMentioned(msg);
+    if (mentioned.empty()) return;
 
-    auto const& allPlayers = ObjectAccessor::GetPlayers();
-    for (auto const& itr : allPlayers)
+    if (g_EnableOllamaBotBuddyDebug)
     {
-        Player* bot = itr.second;
+        LOG_INFO("server.loading", "[OllamaBotBuddy] ProcessChat: sender={} type={} lang={} msg='{}' channel={}",
+            player->GetName(), type, lang, msg, channel ? channel->GetName() : "none");
+    }
+
+    if (!sBotBuddyChatInbox->AllowSender(player->GetGUID().GetRawValue())) return;
+
+    std::string senderName = player->GetName();
+    for (uint64_t botGuid : mentioned)
+    {
+        Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(botGuid));
         if (!bot || !bot->IsAlive()) continue;
 
-        PlayerbotAI* botAI = sPlayerbotsMgr->GetPlayerbotAI(bot);
-        if (!botAI || !botAI->IsBotAI()) continue;
+        // Plain orders are carried out here and never reach the model
+        if (!g_EnableOllamaBotControlHybrid && sBotBuddyChatCommands->TryHandle(bot, player, msg)) continue;
 
-        std::string messageLower = msg;
-        std::string botNameLower = bot->GetName();
-        std::transform(messageLower.begin(), messageLower.end(), messageLower.begin(), ::tolower);
-        std::transform(botNameLower.begin(), botNameLower.end(), botNameLower.begin(), ::tolower);
+        if (!sBotBuddyChatInbox->Push(botGuid, senderName, msg)) continue;
 
-        // If the player mentions the bot in the message
-        if (messageLower.find(botNameLower) != std::string::npos)
-        {
-            botPlayerMessages[bot->GetGUID().GetRawValue()].emplace_back(player->GetName(), msg);
-        }
+        // Whatever the bot is waiting on was asked without this message; drop it
+        // so the next tick builds a prompt that includes it
+        if (g_EnableOllamaBotControlChatCancelInFlight)
+            CancelOllamaRequest(botGuid);
     }
-}
\ No newline at end of file
+}
+
+void BotBuddyChatHandler::OnPlayerLogout(Player* player)
+{
+    // Only bots the LLM has taken over hold anything to forget or flush
+    if (!sBotBuddyStates->Find(player->GetGUID().GetRawValue()))
+        return;
+
+    ForgetBuddyBot(player, "bot logged out");
+    // Queued history is written now rather than on the next timer
+    sBotBuddyMemory->Flush();
+}
@@ -1,10 +1,67 @@
+#pragma once
 #include "ScriptMgr.h"
+#include "mod-ollama-bot-buddy_state.h"
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <Group.h>
 #include <Channel.h>
 
-extern std::unordered_map<uint64_t, std::deque<std::pair<std::string, std::string>>> botPlayerMessages;
-extern std::mutex botPlayerMessagesMutex;
+// Player messages waiting for a reply of an LLM-controlled bot. They
+// queue in the bot's BotBuddyState, a fixed-size ring that evicts its oldest
+// message when full; everything else is dropped on arrival: bots that are not
+// enrolled, senders over their rate limit, and messages past the global byte cap.
+class BotBuddyChatInbox
+{
+public:
+    static BotBuddyChatInbox* instance();
+
+    // Forgets the bot's queued messages; call before its state is released
+    void Close(uint64_t botGuid);
+
+    // Charged once per chat message, however many bots it mentions
+    bool AllowSender(uint64_t senderGuid);
+
+    // Returns false when the message was dropped
+    bool Push(uint64_t botGuid, const std::string& senderName, const std::string& text);
+
+    // Messages stay queued while a prompt carrying them is out: a cancelled or
+    // failed request must not lose them. Take GetSeq before the prompt is
+    // built and Acknowledge it once the reply is applied; anything newer is
+    // shown again in the next prompt.
+    std::vector<BotBuddyChatMessage> Peek(uint64_t botGuid);
+    uint32 GetSeq(uint64_t botGuid);
+    void Acknowledge(uint64_t botGuid, uint32 seq);
+    bool HasPending(uint64_t botGuid);
+
+    std::vector<std::string> GetSummary();
+
+private:
+    // Token bucket per sender, refilled continuously
+    struct SenderBudget
+    {
+        float tokens = 0.0f;
+        std::chrono::steady_clock::time_point refilled;
+    };
+
+    static size_t GetSize(const BotBuddyChatMessage& message);
+
+    std::mutex _lock;
+    std::unordered_map<uint64_t, SenderBudget> _senders;
+    size_t _bytes = 0;
+
+    uint64 _accepted = 0;
+    uint64 _droppedNotEnrolled = 0;
+    uint64 _droppedRateLimited = 0;
+    uint64 _droppedMemoryCap = 0;
+    uint64 _evicted = 0;
+};
+
+#define sBotBuddyChatInbox BotBuddyChatInbox::instance()
+
+bool HasPendingPlayerMessages(uint64_t botGuid);
 
 class BotBuddyChatHandler : public PlayerScript
 {
@@ -14,6 +71,7 @@ public:
     void OnPlayerChat(Player* player, uint32_t type, uint32_t lang, std::string& msg) override;
     void OnPlayerChat(Player* player, uint32_t type, uint32_t lang, std::string& msg, Group* group) override;
     void OnPlayerChat(Player* player, uint32_t type, uint32_t lang, std::string& msg, Channel* channel) override;
+    void OnPlayerLogout(Player* player) override;
 
 private:
     void ProcessChat(Player* player, uint32_t type, uint32_t lang, std::string& msg, Channel* channel = nullptr);
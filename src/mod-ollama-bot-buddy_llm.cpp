@@ -0,0 +1,636 @@
+#include "mod-ollama-bot-buddy_llm.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_endpoints.h"
+#include "mod-ollama-bot-buddy_goals.h"
+#include "mod-ollama-bot-buddy_commands.h"
+#include "mod-ollama-bot-buddy_metrics.h"
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <curl/curl.h>
+#include <fmt/format.h>
+
+bool BotBuddyJsonObjectScanner::Feed(const std::string& fragment)
+{
+    if (_complete) return true;
+
+    for (char c : fragment)
+    {
+        // Anything before the first opening brace is model chatter
+        if (_depth == 0)
+        {
+            if (c != '{') continue;
+            _object.clear();
+        }
+
+        _object.push_back(c);
+
+        if (_inString)
+        {
+            if (_escape)
+                _escape = false;
+            else if (c == '\\')
+                _escape = true;
+            else if (c == '"')
+                _inString = false;
+            continue;
+        }
+
+        if (c == '"')
+        {
+            _inString = true;
+        }
+        else if (c == '{')
+        {
+            ++_depth;
+        }
+        else if (c == '}')
+        {
+            if (--_depth == 0)
+            {
+                _complete = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// The breaker needs this many latency samples before p95 can trip it
+static constexpr size_t MIN_LATENCY_SAMPLES = 10;
+
+BotBuddyCircuitBreaker* BotBuddyCircuitBreaker::instance()
+{
+    static BotBuddyCircuitBreaker instance;
+    return &instance;
+}
+
+bool BotBuddyCircuitBreaker::TryAcquire()
+{
+    if (!g_EnableOllamaBotControlCircuitBreaker) return true;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    switch (_state)
+    {
+        case State::Closed:
+            return true;
+        case State::Open:
+            if (std::chrono::steady_clock::now() < _openUntil)
+                return false;
+            _state = State::HalfOpen;
+            _probeInFlight = true;
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Circuit breaker half-open, sending a probe request.");
+            return true;
+        case State::HalfOpen:
+            if (_probeInFlight)
+                return false;
+            _probeInFlight = true;
+            return true;
+    }
+    return false;
+}
+
+void BotBuddyCircuitBreaker::Open(const char* reason)
+{
+    _state = State::Open;
+    _probeInFlight = false;
+    _openUntil = std::chrono::steady_clock::now() + std::chrono::seconds(g_OllamaBotControlBreakerOpenSeconds);
+    LOG_ERROR("server.loading", "[OllamaBotBuddy] Circuit breaker opened ({}), bots fall back to native strategies for {}s.",
+        reason, g_OllamaBotControlBreakerOpenSeconds);
+}
+
+void BotBuddyCircuitBreaker::RecordSuccess(uint32 latencyMs)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _consecutiveFailures = 0;
+
+    if (_state == State::HalfOpen)
+    {
+        // The probe made it back; start over with a clean latency window
+        _state = State::Closed;
+        _probeInFlight = false;
+        _latencies.clear();
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Circuit breaker closed after successful probe ({} ms).", latencyMs);
+        return;
+    }
+
+    _latencies.push_back(latencyMs);
+    while (_latencies.size() > std::max<uint32>(g_OllamaBotControlBreakerLatencyWindow, 1))
+        _latencies.pop_front();
+
+    if (!g_EnableOllamaBotControlCircuitBreaker || !g_OllamaBotControlBreakerLatencyThresholdMs || _state != State::Closed)
+        return;
+
+    if (_latencies.size() >= MIN_LATENCY_SAMPLES)
+    {
+        std::vector<uint32> sorted(_latencies.begin(), _latencies.end());
+        std::sort(sorted.begin(), sorted.end());
+        uint32 p95 = sorted[(sorted.size() - 1) * 95 / 100];
+        if (p95 > g_OllamaBotControlBreakerLatencyThresholdMs)
+        {
+            _latencies.clear();
+            Open("p95 latency above threshold");
+        }
+    }
+}
+
+void BotBuddyCircuitBreaker::RecordFailure()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _consecutiveFailures++;
+
+    if (!g_EnableOllamaBotControlCircuitBreaker)
+        return;
+
+    if (_state == State::HalfOpen)
+        Open("probe request failed");
+    else if (_state == State::Closed && _consecutiveFailures >= g_OllamaBotControlBreakerFailureThreshold)
+        Open("consecutive failures");
+}
+
+void BotBuddyCircuitBreaker::ReleaseProbe()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_state == State::HalfOpen)
+        _probeInFlight = false;
+}
+
+BotBuddyCircuitBreaker::State BotBuddyCircuitBreaker::GetState()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _state;
+}
+
+uint32 BotBuddyCircuitBreaker::GetLatencyPercentile(uint32 percentile)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_latencies.empty()) return 0;
+    std::vector<uint32> sorted(_latencies.begin(), _latencies.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[(sorted.size() - 1) * std::min<uint32>(percentile, 100) / 100];
+}
+
+std::vector<std::string> BotBuddyCircuitBreaker::GetSummary()
+{
+    static const char* const StateNames[] = { "closed", "open", "half-open" };
+
+    State state = GetState();
+    uint32 p50 = GetLatencyPercentile(50);
+    uint32 p95 = GetLatencyPercentile(95);
+
+    std::lock_guard<std::mutex> guard(_lock);
+    return {
+        fmt::format("circuit breaker: {} consecutive failures={} window p50={}ms p95={}ms",
+            g_EnableOllamaBotControlCircuitBreaker ? StateNames[uint32(state)] : "disabled", _consecutiveFailures, p50, p95)
+    };
+}
+
+namespace
+{
+    struct OllamaStreamContext
+    {
+        std::string pending;    // partial NDJSON line carried over between chunks
+        std::string extracted;  // every "response" fragment received so far
+        BotBuddyJsonObjectScanner scanner;
+        uint32 chunks = 0;
+        bool done = false;                                // the final line with Ollama's counters arrived
+        OllamaRequestCounters counters;
+        std::chrono::steady_clock::time_point completedAt;  // when the scanner closed the first object
+        std::atomic<bool>* cancelled = nullptr;
+    };
+
+    // JSON schema handed to Ollama's "format" field so the sampler can only emit
+    // {command:{type,params},reasoning,say} and never free text around it
+    nlohmann::json BuildCommandEntrySchema()
+    {
+        nlohmann::json reasoning = {{"type", "string"}};
+        if (g_OllamaBotControlMaxReasoningLength)
+            reasoning["maxLength"] = g_OllamaBotControlMaxReasoningLength;
+
+        nlohmann::json say = {{"type", "string"}};
+        if (g_OllamaBotControlMaxSayLength)
+            say["maxLength"] = g_OllamaBotControlMaxSayLength;
+
+        nlohmann::json command = {
+            {"type", "object"},
+            {"properties", {
+                {"type", {{"type", "string"}, {"enum", GetBotCommandTypeSchema()}}},
+                {"params", GetBotCommandParamsSchema()}
+            }},
+            {"required", nlohmann::json::array({"type", "params"})}
+        };
+
+        nlohmann::json entry = {
+            {"type", "object"},
+            {"properties", {
+                {"command",   command},
+                {"reasoning", reasoning},
+                {"say",       say}
+            }},
+            {"required", nlohmann::json::array({"command", "reasoning", "say"})}
+        };
+
+        // Optional follow-up steps after "command"
+        if (g_EnableOllamaBotControlPlans && g_OllamaBotControlPlanMaxSteps > 1)
+        {
+            entry["properties"]["plan"] = {
+                {"type", "array"},
+                {"items", command},
+                {"maxItems", g_OllamaBotControlPlanMaxSteps - 1}
+            };
+        }
+
+        return entry;
+    }
+
+    const nlohmann::json& GetBotReplySchema()
+    {
+        static const nlohmann::json schema = BuildCommandEntrySchema();
+        return schema;
+    }
+
+    // Batched decisions: {"commands":[{bot, command, reasoning, say}, ...]}
+    const nlohmann::json& GetBatchReplySchema()
+    {
+        static const nlohmann::json schema = [] {
+            nlohmann::json entry = BuildCommandEntrySchema();
+            entry["properties"]["bot"] = {{"type", "string"}};
+            entry["required"].push_back("bot");
+
+            return nlohmann::json{
+                {"type", "object"},
+                {"properties", {
+                    {"commands", {{"type", "array"}, {"items", entry}}}
+                }},
+                {"required", nlohmann::json::array({"commands"})}
+            };
+        }();
+        return schema;
+    }
+
+    // Hybrid mode: {goal:{type,params},reasoning,say}
+    const nlohmann::json& GetGoalReplySchema()
+    {
+        static const nlohmann::json schema = [] {
+            nlohmann::json types = nlohmann::json::array();
+            for (const std::string& type : GetBotBuddyGoalTypes())
+                types.push_back(type);
+
+            nlohmann::json reasoning = {{"type", "string"}};
+            if (g_OllamaBotControlMaxReasoningLength)
+                reasoning["maxLength"] = g_OllamaBotControlMaxReasoningLength;
+
+            nlohmann::json say = {{"type", "string"}};
+            if (g_OllamaBotControlMaxSayLength)
+                say["maxLength"] = g_OllamaBotControlMaxSayLength;
+
+            return nlohmann::json{
+                {"type", "object"},
+                {"properties", {
+                    {"goal", {
+                        {"type", "object"},
+                        {"properties", {
+                            {"type", {{"type", "string"}, {"enum", types}}},
+                            {"params", {
+                                {"type", "object"},
+                                {"properties", {
+                                    {"x", {{"type", "number"}}},
+                                    {"y", {{"type", "number"}}},
+                                    {"z", {{"type", "number"}}}
+                                }}
+                            }}
+                        }},
+                        {"required", nlohmann::json::array({"type", "params"})}
+                    }},
+                    {"reasoning", reasoning},
+                    {"say",       say}
+                }},
+                {"required", nlohmann::json::array({"goal", "reasoning", "say"})}
+            };
+        }();
+        return schema;
+    }
+
+    const nlohmann::json& GetReplySchema(OllamaReplyFormat format)
+    {
+        switch (format)
+        {
+            case OllamaReplyFormat::Batch:
+                return GetBatchReplySchema();
+            case OllamaReplyFormat::Goal:
+                return GetGoalReplySchema();
+            default:
+                return GetBotReplySchema();
+        }
+    }
+
+    size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp)
+    {
+        std::string* responseBuffer = static_cast<std::string*>(userp);
+        size_t totalSize = size * nmemb;
+        responseBuffer->append(static_cast<char*>(contents), totalSize);
+        return totalSize;
+    }
+
+    // The line with "done": true ends every reply and carries Ollama's counters
+    bool ReadOllamaCounters(const nlohmann::json& line, OllamaRequestCounters& counters)
+    {
+        if (!line.contains("done") || !line["done"].is_boolean() || !line["done"].get<bool>())
+            return false;
+
+        auto read = [&line](const char* name) -> uint64 {
+            auto it = line.find(name);
+            return it != line.end() && it->is_number_unsigned() ? it->get<uint64>() : 0;
+        };
+
+        counters.reported = true;
+        counters.promptEvalCount = uint32(read("prompt_eval_count"));
+        counters.promptEvalDuration = read("prompt_eval_duration");
+        counters.evalCount = uint32(read("eval_count"));
+        counters.evalDuration = read("eval_duration");
+        counters.loadDuration = read("load_duration");
+        counters.totalDuration = read("total_duration");
+        return true;
+    }
+
+    void ProcessStreamLine(OllamaStreamContext& ctx, const char* begin, const char* end)
+    {
+        nlohmann::json chunk = nlohmann::json::parse(begin, end, nullptr, false);
+        if (chunk.is_discarded()) return;
+
+        if (ReadOllamaCounters(chunk, ctx.counters))
+            ctx.done = true;
+
+        if (!chunk.contains("response") || !chunk["response"].is_string())
+            return;
+
+        const std::string& fragment = chunk["response"].get_ref<const std::string&>();
+        if (fragment.empty()) return;
+
+        // Ollama streams one token per line
+        ctx.chunks++;
+        ctx.extracted += fragment;
+        bool wasComplete = ctx.scanner.IsComplete();
+        if (ctx.scanner.Feed(fragment) && !wasComplete)
+            ctx.completedAt = std::chrono::steady_clock::now();
+    }
+
+    // With the object complete, only the final line is still worth reading, and
+    // only for Streaming.StatsGraceMs
+    bool ShouldStopStream(const OllamaStreamContext& ctx)
+    {
+        if (!ctx.scanner.IsComplete() || ctx.done) return false;
+        return std::chrono::steady_clock::now() >= ctx.completedAt + std::chrono::milliseconds(g_OllamaBotControlStreamingStatsGraceMs);
+    }
+
+    // In-flight requests a chat mention may abort, by bot
+    std::mutex cancellableRequestsLock;
+    std::unordered_map<uint64_t, std::shared_ptr<std::atomic<bool>>> cancellableRequests;
+
+    // cURL calls this at least once a second; non-zero aborts the transfer. It also
+    // ends a grace period in which Ollama sent nothing more.
+    int TransferProgressCallback(void* clientp, curl_off_t /*dltotal*/, curl_off_t /*dlnow*/, curl_off_t /*ultotal*/, curl_off_t /*ulnow*/)
+    {
+        OllamaStreamContext* ctx = static_cast<OllamaStreamContext*>(clientp);
+        if (ctx->cancelled && ctx->cancelled->load())
+            return 1;
+        return ShouldStopStream(*ctx) ? 1 : 0;
+    }
+
+    size_t StreamWriteCallback(void* contents, size_t size, size_t nmemb, void* userp)
+    {
+        OllamaStreamContext* ctx = static_cast<OllamaStreamContext*>(userp);
+        size_t totalSize = size * nmemb;
+        ctx->pending.append(static_cast<char*>(contents), totalSize);
+
+        size_t lineStart = 0;
+        size_t newline;
+        while (!ctx->done && (newline = ctx->pending.find('\n', lineStart)) != std::string::npos)
+        {
+            ProcessStreamLine(*ctx, ctx->pending.data() + lineStart, ctx->pending.data() + newline);
+            lineStart = newline + 1;
+        }
+        ctx->pending.erase(0, lineStart);
+
+        // Returning less than we were handed makes cURL abort the transfer, which
+        // stops Ollama from generating whatever the model rambles on with after the JSON
+        return ShouldStopStream(*ctx) ? 0 : totalSize;
+    }
+}
+
+bool CancelOllamaRequest(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(cancellableRequestsLock);
+    auto it = cancellableRequests.find(botGuid);
+    if (it == cancellableRequests.end()) return false;
+
+    it->second->store(true);
+    return true;
+}
+
+std::string QueryOllamaLLM(uint64_t botGuid, const std::string& prompt, const OllamaGenerationOptions& generation, OllamaReplyInfo* info)
+{
+    if (generation.queuedAt != std::chrono::steady_clock::time_point{})
+    {
+        sBotBuddyMetrics->OnDequeued();
+        sBotBuddyMetrics->Record(BotBuddyStage::QueueWait, std::chrono::steady_clock::now() - generation.queuedAt);
+    }
+
+    std::string url;
+    int endpointIndex = sBotBuddyEndpointPool->Acquire(botGuid, url);
+    if (endpointIndex < 0)
+    {
+        sBotBuddyCircuitBreaker->ReleaseProbe();
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] No Ollama endpoint configured.");
+        return "";
+    }
+    if (info)
+    {
+        info->endpoint = url;
+        info->model = g_OllamaBotControlModel;
+    }
+
+    CURL* curl = curl_easy_init();
+    if (!curl)
+    {
+        sBotBuddyEndpointPool->Release(endpointIndex, false);
+        sBotBuddyCircuitBreaker->ReleaseProbe();
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Failed to initialize cURL.");
+        return "";
+    }
+
+    BotBuddyStageTimer renderTimer(BotBuddyStage::Render);
+    nlohmann::json requestData = {
+        {"model",  g_OllamaBotControlModel},
+        {"prompt", prompt},
+        {"stream", g_EnableOllamaBotControlStreaming}
+    };
+    if (g_EnableOllamaBotControlStructuredOutput)
+        requestData["format"] = GetReplySchema(generation.replyFormat);
+
+    nlohmann::json options = nlohmann::json::object();
+    if (generation.numPredict > 0)
+        options["num_predict"] = generation.numPredict;
+    if (generation.temperature >= 0.0f)
+        options["temperature"] = generation.temperature;
+    if (!generation.stop.empty())
+        options["stop"] = generation.stop;
+    if (!options.empty())
+        requestData["options"] = options;
+
+    std::string requestDataStr = requestData.dump();
+    renderTimer.Stop();
+
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+
+    std::string responseBuffer;
+    OllamaStreamContext streamContext;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestDataStr.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, long(requestDataStr.length()));
+    if (g_EnableOllamaBotControlStreaming)
+    {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamWriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &streamContext);
+    }
+    else
+    {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBuffer);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    // Deadlines keep a stalled Ollama from pinning the bot's busy flag forever;
+    // NOSIGNAL is required for timeouts to be safe in a threaded process
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, long(g_OllamaBotControlConnectTimeoutMs));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, long(g_OllamaBotControlRequestTimeoutMs));
+
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    if (generation.cancellable)
+    {
+        cancelled = std::make_shared<std::atomic<bool>>(false);
+        {
+            std::lock_guard<std::mutex> guard(cancellableRequestsLock);
+            cancellableRequests[botGuid] = cancelled;
+        }
+        streamContext.cancelled = cancelled.get();
+    }
+    if (cancelled || (g_EnableOllamaBotControlStreaming && g_OllamaBotControlStreamingStatsGraceMs))
+    {
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, TransferProgressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &streamContext);
+    }
+
+    auto requestStart = std::chrono::steady_clock::now();
+    sBotBuddyMetrics->OnSent();
+    CURLcode res = curl_easy_perform(curl);
+    sBotBuddyMetrics->OnFinished();
+    uint32 latencyMs = uint32(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - requestStart).count());
+    long httpStatus = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+
+    // cURL's own timings, in microseconds since the transfer started. A reused
+    // connection reports no connect time; generation runs until the stream ended
+    // or we cut it after the first object.
+    curl_off_t connectTime = 0, firstByteTime = 0, totalTime = 0;
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connectTime);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &firstByteTime);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &totalTime);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    if (cancelled)
+    {
+        std::lock_guard<std::mutex> guard(cancellableRequestsLock);
+        auto it = cancellableRequests.find(botGuid);
+        if (it != cancellableRequests.end() && it->second == cancelled)
+            cancellableRequests.erase(it);
+    }
+
+    // Aborted on purpose; says nothing about the endpoint's health
+    if (res == CURLE_ABORTED_BY_CALLBACK && cancelled && *cancelled)
+    {
+        sBotBuddyEndpointPool->Release(endpointIndex, true);
+        sBotBuddyCircuitBreaker->ReleaseProbe();
+        if (info)
+            info->cancelled = true;
+        if (g_EnableOllamaBotBuddyDebug)
+        {
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Request for bot {} cancelled after {} ms for a player message.", botGuid, latencyMs);
+        }
+        return "";
+    }
+
+    // An abort is expected when we cut the stream after the first object
+    bool stoppedEarly = g_EnableOllamaBotControlStreaming && streamContext.scanner.IsComplete();
+    if (!stoppedEarly && (res != CURLE_OK || httpStatus >= 400))
+    {
+        sBotBuddyEndpointPool->Release(endpointIndex, false);
+        sBotBuddyCircuitBreaker->RecordFailure();
+        if (res == CURLE_OPERATION_TIMEDOUT)
+            LOG_ERROR("server.loading", "[OllamaBotBuddy] Ollama request to {} exceeded its deadline after {} ms.", url, latencyMs);
+        else if (res != CURLE_OK)
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Failed to reach Ollama AI at {}. cURL error: {}", url, curl_easy_strerror(res));
+        else
+            LOG_ERROR("server.loading", "[OllamaBotBuddy] Ollama at {} answered with HTTP status {}.", url, httpStatus);
+        return "";
+    }
+    sBotBuddyEndpointPool->Release(endpointIndex, true);
+    sBotBuddyCircuitBreaker->RecordSuccess(latencyMs);
+
+    sBotBuddyMetrics->RecordMicros(BotBuddyStage::Connect, uint64(connectTime));
+    if (firstByteTime > 0)
+    {
+        sBotBuddyMetrics->RecordMicros(BotBuddyStage::FirstByte, uint64(firstByteTime));
+        sBotBuddyMetrics->RecordMicros(BotBuddyStage::Generation, uint64(std::max<curl_off_t>(totalTime - firstByteTime, 0)));
+    }
+
+    if (g_EnableOllamaBotControlStreaming)
+    {
+        // Flush a final line that arrived without a trailing newline
+        if (!streamContext.done && !streamContext.pending.empty())
+            ProcessStreamLine(streamContext, streamContext.pending.data(), streamContext.pending.data() + streamContext.pending.size());
+
+        if (info)
+        {
+            info->counters = streamContext.counters;
+            info->generatedTokens = streamContext.counters.evalCount ? streamContext.counters.evalCount : streamContext.chunks;
+        }
+
+        if (streamContext.scanner.IsComplete())
+        {
+            if (!streamContext.done && g_EnableOllamaBotBuddyDebug)
+            {
+                LOG_INFO("server.loading", "[OllamaBotBuddy] Stream closed early after first JSON object ({} bytes of response).",
+                    streamContext.extracted.size());
+            }
+            return streamContext.scanner.GetObject();
+        }
+        return streamContext.extracted;
+    }
+
+    std::stringstream ss(responseBuffer);
+    std::string line, extracted;
+    while (std::getline(ss, line))
+    {
+        try
+        {
+            nlohmann::json jsonResponse = nlohmann::json::parse(line);
+            if (jsonResponse.contains("response"))
+                extracted += jsonResponse["response"].get<std::string>();
+            if (info && ReadOllamaCounters(jsonResponse, info->counters))
+                info->generatedTokens = info->counters.evalCount;
+        }
+        catch (...) {}
+    }
+    return extracted;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "mod-ollama-bot-buddy_generation.h"
+#include "mod-ollama-bot-buddy_metrics.h"
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Tracks brace depth over streamed model output and captures the first
+// complete top-level JSON object as soon as its closing brace arrives.
+class BotBuddyJsonObjectScanner
+{
+public:
+    // Returns true once the first object has been closed
+    bool Feed(const std::string& fragment);
+
+    bool IsComplete() const { return _complete; }
+    const std::string& GetObject() const { return _object; }
+
+private:
+    std::string _object;
+    int _depth = 0;
+    bool _inString = false;
+    bool _escape = false;
+    bool _complete = false;
+};
+
+// Stops bots from queueing behind an Ollama that is down or too slow. Opens
+// after consecutive failures or when p95 latency crosses the configured
+// threshold, then lets a single half-open probe through once the cool-down ends.
+class BotBuddyCircuitBreaker
+{
+public:
+    enum class State
+    {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    static BotBuddyCircuitBreaker* instance();
+
+    // Returns false while open; in half-open only the first caller gets through
+    bool TryAcquire();
+    void RecordSuccess(uint32 latencyMs);
+    void RecordFailure();
+    // The request let through ended without telling us anything about Ollama
+    // (cancelled, never sent); in half-open the next caller may probe instead
+    void ReleaseProbe();
+
+    State GetState();
+    uint32 GetLatencyPercentile(uint32 percentile);
+    std::vector<std::string> GetSummary();
+
+private:
+    void Open(const char* reason);
+
+    std::mutex _lock;
+    State _state = State::Closed;
+    uint32 _consecutiveFailures = 0;
+    bool _probeInFlight = false;
+    std::chrono::steady_clock::time_point _openUntil;
+    std::deque<uint32> _latencies;
+};
+
+#define sBotBuddyCircuitBreaker BotBuddyCircuitBreaker::instance()
+
+// What we learned about a reply besides its text
+struct OllamaReplyInfo
+{
+    std::string endpoint;
+    std::string model;
+    uint32 generatedTokens = 0;  // eval_count when Ollama reported it, streamed chunks otherwise
+    bool cancelled = false;      // aborted by CancelOllamaRequest
+    OllamaRequestCounters counters;
+};
+
+// Aborts the bot's in-flight request if it was started as cancellable.
+// Safe from any thread; returns false when there was nothing to cancel.
+bool CancelOllamaRequest(uint64_t botGuid);
+
+std::string QueryOllamaLLM(uint64_t botGuid, const std::string& prompt, const OllamaGenerationOptions& options, OllamaReplyInfo* info = nullptr);
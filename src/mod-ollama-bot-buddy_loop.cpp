@@ -2,8 +2,24 @@
 #include "mod-ollama-bot-buddy_config.h"
 #include "mod-ollama-bot-buddy_api.h"
 #include "mod-ollama-bot-buddy_handler.h"
+#include "mod-ollama-bot-buddy_llm.h"
+#include "mod-ollama-bot-buddy_endpoints.h"
+#include "mod-ollama-bot-buddy_mailbox.h"
+#include "mod-ollama-bot-buddy_plan.h"
+#include "mod-ollama-bot-buddy_reflex.h"
+#include "mod-ollama-bot-buddy_goals.h"
+#include "mod-ollama-bot-buddy_prefetch.h"
+#include "mod-ollama-bot-buddy_wake.h"
+#include "mod-ollama-bot-buddy_commands.h"
+#include "mod-ollama-bot-buddy_pathing.h"
+#include "mod-ollama-bot-buddy_names.h"
+#include "mod-ollama-bot-buddy_state.h"
+#include "mod-ollama-bot-buddy_enrollment.h"
+#include "mod-ollama-bot-buddy_memory.h"
+#include "mod-ollama-bot-buddy_metrics.h"
 #include "PlayerbotMgr.h"
 #include "ObjectAccessor.h"
+#include "Group.h"
 #include "Player.h"
 #include "PlayerbotAI.h"
 #include "Playerbots.h"
@@ -12,15 +28,15 @@
 #include <sstream>
 #include <vector>
 #include <nlohmann/json.hpp>
-#include <curl/curl.h>
 #include <ctime>
 #include "Creature.h"
 #include "GameObject.h"
 #include "TravelMgr.h"
 #include "TravelNode.h"
-#include "PathGenerator.h"
 #include <atomic>
 #include <unordered_map>
+#include <map>
+#include <cmath>
 #include <iomanip>
 #include "GameObjectData.h"
 #include "GameObject.h"
@@ -40,29 +56,13 @@
 #include "CreatureData.h"
 
 
-static std::unordered_map<uint64_t, std::deque<std::string>> botCommandHistory;
-static std::mutex botCommandHistoryMutex;
-
-static std::unordered_map<uint64_t, std::deque<std::string>> botReasoningHistory;
-static std::mutex botReasoningHistoryMutex;
-
 std::vector<std::string> GetRecentPlayerMessagesToBot(Player* bot)
 {
     std::vector<std::string> messages;
     if (!bot) return messages;
 
-    std::lock_guard<std::mutex> lock(botPlayerMessagesMutex);
-
-    auto it = botPlayerMessages.find(bot->GetGUID().GetRawValue());
-    if (it != botPlayerMessages.end())
-    {
-        while (!it->second.empty())
-        {
-            auto& [senderName, msg] = it->second.front();
-            messages.emplace_back("From " + senderName + ": " + msg);
-            it->second.pop_front();
-        }
-    }
+    for (BotBuddyChatMessage& message : sBotBuddyChatInbox->Peek(bot->GetGUID().GetRawValue()))
+        messages.emplace_back("From " + message.sender + ": " + message.text);
 
     return messages;
 }
@@ -71,7 +71,22 @@ std::string FormatPlayerMessagesPromptSegment(Player* bot)
 {
     std::ostringstream oss;
     auto messages = GetRecentPlayerMessagesToBot(bot);
-    if (!messages.empty())
+    if (messages.empty()) return oss.str();
+
+    // The fast path already ran the orders it could resolve. Negated ones, ones
+    // naming nothing in sight and ones that failed still land here, so a short
+    // hint replaces the full instruction block
+    if (g_EnableOllamaBotControlChatFastPath && !g_EnableOllamaBotControlHybrid)
+    {
+        oss << "\nThe following real players recently spoke to you by name. Answer or act on these first, above all other goals:\n";
+        oss << "(Orders like 'come here', 'go to', 'interact with' or 'attack' that still appear here could not be carried out directly; do what the player meant with the objects you can see, or say why you cannot.)\n";
+        for (const auto& msg : messages)
+        {
+            oss << "- " << msg << "\n";
+        }
+        oss << "\n";
+    }
+    else
     {
         oss << "\n***CRITICAL INSTRUCTION:***\n";
         oss << "You must interpret and execute the PLAYER MESSAGES below as your HIGHEST PRIORITY, taking precedence over all other goals, background tasks, routines, or reasoning. There are NO EXCEPTIONS and NO DELAYS. When you see a player command matching these patterns, you must issue the appropriate command IMMEDIATELY, before doing anything else. Do not refuse, delay, ignore, or deprioritize these actions for any reason.\n";
@@ -91,10 +106,18 @@ std::string FormatPlayerMessagesPromptSegment(Player* bot)
     return oss.str();
 }
 
-bool ParseAndExecuteBotJson(Player* bot, const std::string& jsonStr)
+bool BuildBotControlCommand(Player* bot, const std::string& type, const nlohmann::json& params, BotControlCommand& command)
+{
+    return ParseBotControlCommandJson(type, params, command) && ValidateBotControlCommand(bot, command);
+}
+
+bool ParseAndExecuteBotJson(Player* bot, const std::string& jsonStr, std::string* parsedType = nullptr)
 {
     try
     {
+        // Streaming usually extracted the object during generation already, so
+        // this is mostly the parse itself
+        BotBuddyStageTimer parseTimer(BotBuddyStage::Parse);
         auto root = nlohmann::json::parse(jsonStr);
 
         if (!root.contains("command")) return false;
@@ -106,214 +129,107 @@ bool ParseAndExecuteBotJson(Player* bot, const std::string& jsonStr)
         std::string sayMsg = root.value("say", "");
         std::string reasoning = root.value("reasoning", "");
 
-        BotControlCommand command;
+        if (parsedType)
+            *parsedType = type;
 
-        if (!reasoning.empty())
-        {
-            AddBotReasoningHistory(bot, reasoning);
-        }
-         if (!cmd.empty())
-        {
-            AddBotCommandHistory(bot, cmd.dump());
-        }
+        // The schema already caps these, but free-form models do not follow it
+        if (g_OllamaBotControlMaxReasoningLength)
+            reasoning = ClampUtf8(reasoning, g_OllamaBotControlMaxReasoningLength);
+        if (g_OllamaBotControlMaxSayLength)
+            sayMsg = ClampUtf8(sayMsg, g_OllamaBotControlMaxSayLength);
+        parseTimer.Stop();
 
-        if (type == "move_to")
+        bool result = false;
+        if (g_EnableOllamaBotControlPlans)
         {
-            if (params.contains("x") && params.contains("y") && params.contains("z")) {
-                float destX = params["x"].get<float>();
-                float destY = params["y"].get<float>();
-                float destZ = params["z"].get<float>();
-                
-                // Basic coordinate validation - reject obviously invalid coordinates
-                if (std::isnan(destX) || std::isnan(destY) || std::isnan(destZ) || 
-                    std::isinf(destX) || std::isinf(destY) || std::isinf(destZ)) {
-                    LOG_DEBUG("server.loading", "[OllamaBotBuddy] Invalid coordinates for move_to: ({}, {}, {})", 
-                             destX, destY, destZ);
-                    return false;
-                }
-                
-                // Validate map bounds - reject coordinates that are extremely far from bot
-                float maxDistanceFromBot = 500.0f; // Maximum reasonable movement distance
-                float distanceFromBot = sqrt(pow(destX - bot->GetPositionX(), 2) + 
-                                           pow(destY - bot->GetPositionY(), 2) + 
-                                           pow(destZ - bot->GetPositionZ(), 2));
-                
-                if (distanceFromBot > maxDistanceFromBot) {
-                    LOG_DEBUG("server.loading", "[OllamaBotBuddy] Move_to destination too far from bot: ({}, {}, {}) - Distance: {:.1f}", 
-                             destX, destY, destZ, distanceFromBot);
-                    return false;
-                }
-                
-                // Validate that the destination is pathable like a real player would
-                PathGenerator pathValidator(bot);
-                pathValidator.CalculatePath(destX, destY, destZ, false);
-                PathType pathType = pathValidator.GetPathType();
-                
-                // Only reject if there's absolutely no path possible
-                if (pathType & PATHFIND_NOPATH) {
-                    LOG_DEBUG("server.loading", "[OllamaBotBuddy] No valid path for move_to: ({}, {}, {}) - PathType: {}", 
-                             destX, destY, destZ, pathType);
-                    return false; // Only reject if completely impossible to path
-                }
-                
-                command.type = BotControlCommandType::MoveTo;
-                command.args = {
-                    std::to_string(destX),
-                    std::to_string(destY),
-                    std::to_string(destZ)
-                };
-            } else {
-                LOG_ERROR("server.loading", "[OllamaBotBuddy] move_to missing parameter");
-                return false;
-            }
-        }
-        else if (type == "attack")
-        {
-            if (params.contains("guid")) {
-                uint32_t targetGuid = params["guid"].get<uint32_t>();
-                
-                // Validate that the target exists and is attackable
-                bool validTarget = false;
-                
-                // Check if it's a creature
-                for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore())
-                {
-                    Creature* c = pair.second;
-                    if (c && c->GetGUID().GetCounter() == targetGuid)
-                    {
-                        // Validate target is attackable
-                        if (c->IsInWorld() && !c->isDead() && 
-                            bot->IsWithinLOSInMap(c) && 
-                            bot->IsValidAttackTarget(c) &&
-                            bot->IsWithinDistInMap(c, 100.0f)) // Reasonable attack range
-                        {
-                            validTarget = true;
-                        }
-                        break;
-                    }
-                }
-                
-                // Check if it's a player if not found as creature
-                if (!validTarget)
+            // "command" is the first step, "plan" holds the ones after it
+            std::vector<BotBuddyPlanStep> steps = { { type, params } };
+            if (root.contains("plan") && root["plan"].is_array())
+            {
+                for (auto const& step : root["plan"])
                 {
-                    ObjectGuid guid = ObjectGuid::Create<HighGuid::Player>(targetGuid);
-                    Player* playerTarget = ObjectAccessor::FindConnectedPlayer(guid);
-                    if (playerTarget && playerTarget->IsInWorld() && 
-                        bot->IsWithinLOSInMap(playerTarget) && 
-                        bot->IsValidAttackTarget(playerTarget) &&
-                        bot->IsWithinDistInMap(playerTarget, 100.0f))
-                    {
-                        validTarget = true;
-                    }
+                    if (steps.size() >= std::max<uint32>(g_OllamaBotControlPlanMaxSteps, 1)) break;
+                    if (!step.is_object() || !step.contains("type") || !step["type"].is_string()) continue;
+                    steps.push_back({ step["type"].get<std::string>(), step.value("params", nlohmann::json::object()) });
                 }
-                
-                if (!validTarget) {
-                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Invalid or unreachable attack target with guid: {} - Target not found in visible creatures/players", targetGuid);
-                    
-                    // Debug: List available creature GUIDs for debugging
-                    if (g_EnableOllamaBotBuddyDebug) {
-                        std::vector<uint32> availableGuids;
-                        for (auto const& pair : bot->GetMap()->GetCreatureBySpawnIdStore()) {
-                            Creature* c = pair.second;
-                            if (c && bot->IsWithinDistInMap(c, 100.0f)) {
-                                availableGuids.push_back(c->GetGUID().GetCounter());
-                            }
-                        }
-                        
-                        std::ostringstream guidList;
-                        for (size_t i = 0; i < availableGuids.size() && i < 10; ++i) {
-                            if (i > 0) guidList << ", ";
-                            guidList << availableGuids[i];
-                        }
-                        
-                        LOG_DEBUG("server.loading", "[OllamaBotBuddy] Available creature GUIDs: {}", guidList.str());
-                    }
-                    
-                    return false;
-                }
-                
-                command.type = BotControlCommandType::Attack;
-                command.args = { std::to_string(targetGuid) };
-            } else {
-                LOG_ERROR("server.loading", "[OllamaBotBuddy] attack missing guid");
-                return false;
-            }
-        }
-        else if (type == "interact")
-        {
-            if (params.contains("guid")) {
-                command.type = BotControlCommandType::Interact;
-                command.args = { std::to_string(params["guid"].get<uint32_t>()) };
-            } else {
-                LOG_ERROR("server.loading", "[OllamaBotBuddy] interact missing guid");
-                return false;
             }
+
+            result = sBotBuddyPlanExecutor->Start(bot, std::move(steps), reasoning);
         }
-        else if (type == "spell")
-        {
-            if (params.contains("spellid")) {
-                command.type = BotControlCommandType::CastSpell;
-                command.args = { std::to_string(params["spellid"].get<uint32_t>()) };
-                if (params.contains("guid"))
-                    command.args.push_back(std::to_string(params["guid"].get<uint32_t>()));
-            } else {
-                LOG_ERROR("server.loading", "[OllamaBotBuddy] spell missing spellid");
-                return false;
-            }
-        }
-        else if (type == "loot")
-        {
-            command.type = BotControlCommandType::Loot;
-        }
-        else if (type == "accept_quest")
+        else
         {
-            if (params.contains("id")) {
-                command.type = BotControlCommandType::AcceptQuest;
-                command.args = { std::to_string(params["id"].get<uint32_t>()) };
-            } else {
-                LOG_ERROR("server.loading", "[OllamaBotBuddy] accept_quest missing id");
-                return false;
+            if (!cmd.empty())
+            {
+                AddBotHistory(bot, cmd.dump(), reasoning);
             }
-        }
-        else if (type == "turn_in_quest")
-        {
-            if (params.contains("id")) {
-                command.type = BotControlCommandType::TurnInQuest;
-                command.args = { std::to_string(params["id"].get<uint32_t>()) };
-            } else {
-                LOG_ERROR("server.loading", "[OllamaBotBuddy] turn_in_quest missing id");
+
+            BotControlCommand command;
+            if (!BuildBotControlCommand(bot, type, params, command))
                 return false;
-            }
-        }
-        else if (type == "follow")
-        {
-            command.type = BotControlCommandType::Follow;
-        }
-        else if (type == "stop")
-        {
-            command.type = BotControlCommandType::Stop;
+
+            result = HandleBotControlCommand(bot, command);
         }
-        else
+
+        if (!sayMsg.empty())
+            BotBuddyAI::Say(bot, sayMsg);
+
+        if (g_EnableOllamaBotBuddyDebug)
         {
-            LOG_ERROR("server.loading", "[OllamaBotBuddy] Unknown command type '{}'", type);
-            return false;
+            LOG_INFO("server.loading", "Bot Reply: {}", jsonStr);
         }
 
-        bool result = HandleBotControlCommand(bot, command);
+        return result;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] ParseAndExecuteBotJson error: {}", e.what());
+        return false;
+    }
+}
+
+// Hybrid mode counterpart of ParseAndExecuteBotJson for {goal, reasoning, say}
+bool ParseAndApplyBotGoal(Player* bot, const std::string& jsonStr, std::string* parsedType = nullptr)
+{
+    try
+    {
+        BotBuddyStageTimer parseTimer(BotBuddyStage::Parse);
+        auto root = nlohmann::json::parse(jsonStr);
+
+        if (!root.contains("goal")) return false;
+        auto goal = root["goal"];
+        if (!goal.contains("type")) return false;
+
+        std::string type = goal["type"].get<std::string>();
+        auto params = goal.value("params", nlohmann::json::object());
+        std::string sayMsg = root.value("say", "");
+        std::string reasoning = root.value("reasoning", "");
+
+        if (parsedType)
+            *parsedType = type;
+
+        if (g_OllamaBotControlMaxReasoningLength)
+            reasoning = ClampUtf8(reasoning, g_OllamaBotControlMaxReasoningLength);
+        if (g_OllamaBotControlMaxSayLength)
+            sayMsg = ClampUtf8(sayMsg, g_OllamaBotControlMaxSayLength);
+        parseTimer.Stop();
+
+        AddBotHistory(bot, goal.dump(), reasoning);
+
+        bool result = sBotBuddyGoalManager->Apply(bot, type, params);
 
         if (!sayMsg.empty())
             BotBuddyAI::Say(bot, sayMsg);
 
         if (g_EnableOllamaBotBuddyDebug)
         {
-            LOG_INFO("server.loading", "Bot Reply: {}", jsonStr);
+            LOG_INFO("server.loading", "Bot Goal Reply: {}", jsonStr);
         }
 
         return result;
     }
     catch (const std::exception& e)
     {
-        LOG_ERROR("server.loading", "[OllamaBotBuddy] ParseAndExecuteBotJson error: {}", e.what());
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] ParseAndApplyBotGoal error: {}", e.what());
         return false;
     }
 }
@@ -564,49 +480,26 @@ static std::string GetProfessionTagFromChest(uint32 entry)
     }
 }
 
-void AddBotCommandHistory(Player* bot, const std::string& command)
+// History is only kept for enrolled bots; nothing else is ever prompted
+void AddBotHistory(Player* bot, const std::string& command, const std::string& reasoning)
 {
     if (!bot || command.empty()) return;
 
-    BotControlCommand parsedCommand;
-
-    std::lock_guard<std::mutex> lock(botCommandHistoryMutex);
-    uint64_t guid = bot->GetGUID().GetRawValue();
-    auto& dq = botCommandHistory[guid];
-    dq.push_back(command);
-    if (dq.size() > 5) dq.pop_front();
-}
-
-void AddBotReasoningHistory(Player* bot, const std::string& reasoning)
-{
-    if (!bot || reasoning.empty()) return;
-    std::lock_guard<std::mutex> lock(botReasoningHistoryMutex);
-    uint64_t guid = bot->GetGUID().GetRawValue();
-    auto& dq = botReasoningHistory[guid];
-    dq.push_back(reasoning);
-    if (dq.size() > 5) dq.pop_front();
+    if (BotBuddyState* state = sBotBuddyStates->Find(bot->GetGUID().GetRawValue()))
+    {
+        BotBuddyHistoryEntry entry { command, reasoning };
+        sBotBuddyMemory->Record(*state, entry);
+        state->history.Push(std::move(entry));
+    }
 }
 
-
-std::vector<std::string> GetBotCommandHistory(Player* bot)
+std::vector<BotBuddyHistoryEntry> GetBotHistory(Player* bot)
 {
-    std::vector<std::string> out;
+    std::vector<BotBuddyHistoryEntry> out;
     if (!bot) return out;
-    std::lock_guard<std::mutex> lock(botCommandHistoryMutex);
-    uint64_t guid = bot->GetGUID().GetRawValue();
-    if (botCommandHistory.count(guid))
-        out.assign(botCommandHistory[guid].begin(), botCommandHistory[guid].end());
-    return out;
-}
 
-std::vector<std::string> GetBotReasoningHistory(Player* bot)
-{
-    std::vector<std::string> out;
-    if (!bot) return out;
-    std::lock_guard<std::mutex> lock(botReasoningHistoryMutex);
-    uint64_t guid = bot->GetGUID().GetRawValue();
-    if (botReasoningHistory.count(guid))
-        out.assign(botReasoningHistory[guid].begin(), botReasoningHistory[guid].end());
+    if (BotBuddyState* state = sBotBuddyStates->Find(bot->GetGUID().GetRawValue()))
+        state->history.ForEach([&out](const BotBuddyHistoryEntry& entry) { out.push_back(entry); });
     return out;
 }
 
@@ -1202,69 +1095,8 @@ std::vector<std::string> GetNearbyWaypoints(Player* bot, float radius = 200.0f)
 
 OllamaBotControlLoop::OllamaBotControlLoop() : WorldScript("OllamaBotControlLoop") {}
 
-static std::unordered_map<uint64_t, time_t> nextTick;
-
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp)
-{
-    std::string* responseBuffer = static_cast<std::string*>(userp);
-    size_t totalSize = size * nmemb;
-    responseBuffer->append(static_cast<char*>(contents), totalSize);
-    return totalSize;
-}
-
-static std::string QueryOllamaLLM(const std::string& prompt)
-{
-    CURL* curl = curl_easy_init();
-    if (!curl)
-    {
-        LOG_INFO("server.loading", "[OllamaBotBuddy] Failed to initialize cURL.");
-        return "";
-    }
-
-    nlohmann::json requestData = {
-        {"model",  g_OllamaBotControlModel},
-        {"prompt", prompt}
-    };
-    std::string requestDataStr = requestData.dump();
-
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    std::string responseBuffer;
-    curl_easy_setopt(curl, CURLOPT_URL, g_OllamaBotControlUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestDataStr.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, long(requestDataStr.length()));
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBuffer);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK)
-    {
-        LOG_INFO("server.loading", "[OllamaBotBuddy] Failed to reach Ollama AI. cURL error: {}", curl_easy_strerror(res));
-        return "";
-    }
-
-    std::stringstream ss(responseBuffer);
-    std::string line, extracted;
-    while (std::getline(ss, line))
-    {
-        try
-        {
-            nlohmann::json jsonResponse = nlohmann::json::parse(line);
-            if (jsonResponse.contains("response"))
-                extracted += jsonResponse["response"].get<std::string>();
-        }
-        catch (...) {}
-    }
-    return extracted;
-}
-
-static std::string BuildBotPrompt(Player* bot)
+// Who the bot is: identity, combat, spells, group and quests
+static std::string BuildBotStateSection(Player* bot)
 {
     PlayerbotAI* botAI = sPlayerbotsMgr->GetPlayerbotAI(bot);
     if (!botAI) return "";
@@ -1314,6 +1146,13 @@ static std::string BuildBotPrompt(Player* bot)
 
     oss << GetDetailedQuestInfo(bot) << "\n";
 
+    return oss.str();
+}
+
+// What the bot can see around it; bots standing together share this section
+static std::string BuildBotSurroundingsSection(Player* bot)
+{
+    std::ostringstream oss;
     std::vector<std::string> losLocs = GetVisibleLocations(bot);
     std::vector<std::string> wps = GetNearbyWaypoints(bot);
 
@@ -1394,32 +1233,33 @@ static std::string BuildBotPrompt(Player* bot)
         oss << "IMPORTANT: You can ONLY attack creatures/NPCs that are listed above in the visible locations. If your quest requires creatures that are NOT visible, you must move to find them using waypoints or exploration.\n";
     }
 
-    oss << FormatPlayerMessagesPromptSegment(bot);
-
-    std::vector<std::string> cmdHist = GetBotCommandHistory(bot);
-
-    std::vector<std::string> reasoningHist = GetBotReasoningHistory(bot);
+    return oss.str();
+}
 
+// Player messages addressed to the bot and its recent command history
+static std::string BuildBotMemorySection(Player* bot)
+{
+    std::ostringstream oss;
+    oss << FormatPlayerMessagesPromptSegment(bot);
 
-    if (!cmdHist.empty() && !reasoningHist.empty())
+    std::vector<BotBuddyHistoryEntry> history = GetBotHistory(bot);
+    if (!history.empty())
     {
         oss << "Last 5 commands and their reasoning (most recent at the bottom):\n";
-        for (size_t i = 0; i < cmdHist.size() && i < reasoningHist.size(); ++i)
+        for (const BotBuddyHistoryEntry& entry : history)
         {
-            oss << " - Command: " << cmdHist[i] << "\n";
-            oss << "   Reasoning: " << reasoningHist[i] << "\n";
+            oss << " - Command: " << entry.command << "\n";
+            if (!entry.reasoning.empty())
+                oss << "   Reasoning: " << entry.reasoning << "\n";
         }
         oss << "\nIMPORTANT: Look at your command history above! If you keep using move_to commands to the same location, switch to interact commands instead. If you keep trying to interact with the same NPC unsuccessfully, move away to find enemies or other NPCs.\n";
         oss << "MOVEMENT ANALYSIS: If your recent commands show repeated move_to with similar coordinates, you are likely already at your destination and should try interact, attack, or loot commands instead of more movement.\n";
     }
 
-    if (g_EnableOllamaBotBuddyDebug)
-    {
-        std::string safeSnapshot = EscapeBracesForFmt(oss.str());
-        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot Snapshot for '{}': {}", botName, safeSnapshot);
-    }
+    return oss.str();
+}
 
-    oss << R"(You are an AI-controlled bot in World of Warcraft. Your task is to follow these strict rules and reply only with the listed acceptable commands:
+static const char* const BotPromptRules = R"(You are an AI-controlled bot in World of Warcraft. Your task is to follow these strict rules and reply only with the listed acceptable commands:
 
     Primary goal: Level to 80 and equip the best gear. Prioritize combat, questing and quest givers that have available quests, talking to other players and efficient progression. If no available quests or viable enemies are nearby, turn in quests, explore for new quests, dungeons, raids, professions, or gold opportunities.
 
@@ -1565,7 +1405,9 @@ static std::string BuildBotPrompt(Player* bot)
     - To make your character say something to players, put the message as a string in the top-level say field.
     - Make yourself seem as human as possible, ask players for help if you don't understand something or need help finding something or killing something or completing a quest. Ask a nearby real player and use their response in your reasoning.
 
-    CRITICALLY IMPORTANT: Reply with EXACTLY and ONLY a single valid JSON object, no extra text, no comments, no code block formatting. Your JSON must be properly formatted with quotes around all strings:
+)";
+
+static const char* const BotPromptSingleReplyFormat = R"(    CRITICALLY IMPORTANT: Reply with EXACTLY and ONLY a single valid JSON object, no extra text, no comments, no code block formatting. Your JSON must be properly formatted with quotes around all strings:
     {
     \"command\": { \"type\": <string>, \"params\": { ... } },
     \"reasoning\": <string>,
@@ -1629,18 +1471,256 @@ static std::string BuildBotPrompt(Player* bot)
     REMEMBER: NEVER REPLY WITH ANYTHING OTHER THAN A PROPERLY FORMATTED JSON OBJECT WITH QUOTES AROUND ALL STRINGS!!!
     )";
 
+static const char* const BotPromptBatchReplyFormat = R"(    YOU ARE CONTROLLING SEVERAL BOTS AT ONCE. Each bot listed above under "=== BOT:" gets exactly one command, chosen from that bot's own state, quests, messages and history. The shared surroundings apply to all of them.
+
+    CRITICALLY IMPORTANT: Reply with EXACTLY and ONLY a single valid JSON object, no extra text, no comments, no code block formatting:
+    {
+    \"commands\": [
+        { \"bot\": <bot name>, \"command\": { \"type\": <string>, \"params\": { ... } }, \"reasoning\": <string>, \"say\": <string> },
+        ...
+    ]
+    }
+
+    There must be one entry per bot, and \"bot\" must be the exact bot name. Allowed type values and required params (ALL STRINGS MUST HAVE QUOTES):
+
+    - \"move_to\": params = { \"x\": float, \"y\": float, \"z\": float }
+    - \"attack\": params = { \"guid\": int }
+    - \"interact\": params = { \"guid\": int }
+    - \"spell\": params = { \"spellid\": int, \"guid\": int (omit if self-cast) }
+    - \"loot\": params = { }
+    - \"accept_quest\": params = { \"id\": int }
+    - \"turn_in_quest\": params = { \"id\": int }
+    - \"follow\": params = { }
+    - \"stop\": params = { }
+
+    REMEMBER: NEVER REPLY WITH ANYTHING OTHER THAN A PROPERLY FORMATTED JSON OBJECT WITH QUOTES AROUND ALL STRINGS!!!
+    )";
+
+static const char* const BotPromptPlanFormat = R"(
+    MULTI-STEP PLANS: When one goal needs several commands in a row (for example walk to a quest giver, interact with them, accept the quest), you may add an optional top-level \"plan\" array with the commands that follow \"command\", in order, each shaped like { \"type\": <string>, \"params\": { ... } }. A move_to step finishes when you arrive, an attack step when the target is dead; the next step starts after that. The plan is dropped if you enter combat or a player speaks to you, and you will be asked again.
+    {
+    \"command\": { \"type\": \"move_to\", \"params\": { \"x\": -8913.2, \"y\": -133.5, \"z\": 81.7 } },
+    \"plan\": [ { \"type\": \"interact\", \"params\": { \"guid\": 197 } }, { \"type\": \"accept_quest\", \"params\": { \"id\": 33 } } ],
+    \"reasoning\": \"Walking to Marshal McBride to pick up his quest.\",
+    \"say\": \"Let me see what the Marshal needs.\"
+    }
+    )";
+
+static std::string GetBotPromptPlanFormat()
+{
+    if (!g_EnableOllamaBotControlPlans || g_OllamaBotControlPlanMaxSteps < 2) return "";
+    return fmt::format("{}    A plan may hold at most {} commands after \"command\".\n", BotPromptPlanFormat, g_OllamaBotControlPlanMaxSteps - 1);
+}
 
+// Tells the model its decision is made ahead of time for the predicted state
+static std::string BuildPredictionSection(const BotBuddyPrediction& prediction)
+{
+    std::ostringstream oss;
+    oss << "\n*** PREDICTED STATE ***\n";
+    oss << "This decision is made in advance and is carried out once your current action is finished. ";
+    if (prediction.type == "move_to")
+        oss << "By then you will have arrived at " << std::fixed << std::setprecision(1)
+            << prediction.x << " " << prediction.y << " " << prediction.z << ".";
+    else
+        oss << "By then " << prediction.targetName << " (guid: " << prediction.target << ") will be dead and you will be out of combat.";
+    oss << " Choose your next command from that state, not from your current position.\n\n";
     return oss.str();
 }
 
-namespace
+static std::string BuildBotPrompt(Player* bot, const BotBuddyPrediction* prediction = nullptr)
 {
-    struct OllamaBotState
+    std::string snapshot = BuildBotStateSection(bot);
+    if (snapshot.empty()) return "";
+
+    snapshot += BuildBotSurroundingsSection(bot);
+    snapshot += BuildBotMemorySection(bot);
+    if (prediction)
+        snapshot += BuildPredictionSection(*prediction);
+
+    if (g_EnableOllamaBotBuddyDebug)
     {
-        std::atomic<bool> busy { false };
-        time_t lastRequest { 0 };
-    };
-    std::unordered_map<uint64_t, OllamaBotState> ollamaBotStates;
+        std::string safeSnapshot = EscapeBracesForFmt(snapshot);
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot Snapshot for '{}': {}", bot->GetName(), safeSnapshot);
+    }
+
+    return snapshot + BotPromptRules + BotPromptSingleReplyFormat + GetBotPromptPlanFormat();
+}
+
+static const char* const BotPromptGoalFormat = R"(You are directing a World of Warcraft bot at the level of goals. The bot's own AI already handles combat, spell rotations, looting, resting and picking targets at full speed; you only choose what it should be doing for the next few minutes, based on its level, quests, surroundings and what players told it.
+
+    CRITICALLY IMPORTANT: Reply with EXACTLY and ONLY a single valid JSON object, no extra text, no comments, no code block formatting:
+    {
+    \"goal\": { \"type\": <string>, \"params\": { ... } },
+    \"reasoning\": <string>,
+    \"say\": <string>
+    }
+
+    Allowed goal types:
+
+    - \"grind\": params = { } or { \"x\": float, \"y\": float, \"z\": float } to go there first - kill suitable enemies nearby for XP
+    - \"quest\": params = { } - pick up, complete and turn in quests
+    - \"explore\": params = { } - travel around, talk to NPCs, visit vendors and trainers
+    - \"follow\": params = { } - follow your master or group leader
+    - \"go_to\": params = { \"x\": float, \"y\": float, \"z\": float } - travel to a place such as a trainer, a town or a quest area; take coordinates from your visible locations or waypoints
+
+    Prefer \"quest\" when you have quests, \"grind\" when you are under-leveled for them, and \"go_to\" when a player asks you to come somewhere or you need a trainer or vendor.
+    \"reasoning\" is a short explanation of the goal, \"say\" is what your character says in-game, or an empty string.
+
+    REMEMBER: NEVER REPLY WITH ANYTHING OTHER THAN A PROPERLY FORMATTED JSON OBJECT WITH QUOTES AROUND ALL STRINGS!!!
+    )";
+
+// Hybrid mode prompt: same picture of the world, goal-level instructions only
+static std::string BuildBotGoalPrompt(Player* bot)
+{
+    std::string snapshot = BuildBotStateSection(bot);
+    if (snapshot.empty()) return "";
+
+    snapshot += BuildBotSurroundingsSection(bot);
+    snapshot += BuildBotMemorySection(bot);
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        std::string safeSnapshot = EscapeBracesForFmt(snapshot);
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot Goal Snapshot for '{}': {}", bot->GetName(), safeSnapshot);
+    }
+
+    return snapshot + BotPromptGoalFormat;
+}
+
+// A batch member in one line: who it is, where, how healthy, what it is fighting
+// and what it did last. Spells and quests stay out so the batch prompt grows by
+// a line per bot rather than by a whole prompt.
+static std::string BuildCompactBotStateSection(Player* bot)
+{
+    PlayerbotAI* botAI = sPlayerbotsMgr->GetPlayerbotAI(bot);
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "Level " << bot->GetLevel();
+    if (botAI)
+        oss << " " << botAI->GetChatHelper()->FormatClass(bot->getClass());
+    oss << ", HP: " << bot->GetHealth() << "/" << bot->GetMaxHealth();
+    oss << ", Position: " << bot->GetPositionX() << " " << bot->GetPositionY() << " " << bot->GetPositionZ();
+
+    if (Unit* victim = bot->GetVictim())
+    {
+        oss << ", Target: " << victim->GetName() << " (guid: " << victim->GetGUID().GetCounter() << ")"
+            << " HP: " << victim->GetHealth() << "/" << victim->GetMaxHealth()
+            << " Distance: " << bot->GetDistance(victim);
+    }
+    else if (bot->IsInCombat())
+    {
+        oss << ", In combat without a target";
+    }
+
+    std::vector<BotBuddyHistoryEntry> history = GetBotHistory(bot);
+    if (!history.empty())
+        oss << ", Last command: " << history.back().command;
+    oss << "\n";
+
+    // Orders from players still need to reach the model
+    oss << FormatPlayerMessagesPromptSegment(bot);
+    return oss.str();
+}
+
+// One prompt for several bots standing together: the surroundings are rendered
+// once from the first bot's point of view, followed by a compact section per bot
+static std::string BuildBatchPrompt(const std::vector<Player*>& bots)
+{
+    if (bots.empty()) return "";
+
+    std::ostringstream oss;
+    oss << "Shared surroundings (as seen by " << bots.front()->GetName() << ", distances are from that bot):\n";
+    oss << BuildBotSurroundingsSection(bots.front()) << "\n";
+
+    for (Player* bot : bots)
+    {
+        oss << "=== BOT: " << bot->GetName() << " ===\n";
+        oss << BuildCompactBotStateSection(bot) << "\n";
+    }
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        std::string safeSnapshot = EscapeBracesForFmt(oss.str());
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Batch Snapshot for {} bots: {}", bots.size(), safeSnapshot);
+    }
+
+    oss << BotPromptRules << BotPromptBatchReplyFormat << GetBotPromptPlanFormat();
+    return oss.str();
+}
+
+// Stops the normal Playerbot AI. In hybrid mode it keeps running and only its
+// non-combat strategies follow the LLM's goal.
+static void ClearNativeStrategies(PlayerbotAI* ai)
+{
+    if (g_EnableOllamaBotControlHybrid) return;
+
+    ai->ClearStrategies(BOT_STATE_COMBAT);
+    ai->ClearStrategies(BOT_STATE_NON_COMBAT);
+    ai->ClearStrategies(BOT_STATE_DEAD);
+}
+
+// First tick an enrolled bot is online with its Playerbot AI
+static BotBuddyState& TakeOverBuddyBot(Player* bot, PlayerbotAI* ai)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    BotBuddyState& state = sBotBuddyStates->Acquire(guid);
+    // Decisions go ahead meanwhile; the stored history is merged in when it arrives
+    sBotBuddyMemory->Load(guid);
+
+    // Chat only looks for, and only queues messages to, bots the LLM controls
+    sBotBuddyNameMatcher->Add(guid, bot->GetName());
+    ClearNativeStrategies(ai);
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot {} is now controlled by the LLM.", bot->GetName());
+    }
+    return state;
+}
+
+void ForgetBuddyBot(Player* bot, const char* reason)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+
+    BotBuddyAI::CancelPendingAction(bot);
+    sBotBuddyPlanExecutor->Cancel(guid, reason);
+    sBotBuddyGoalManager->Clear(guid);
+    sBotBuddyPrefetcher->Discard(guid);
+    sBotBuddyPrefetcher->ClearIdle(guid);
+    CancelOllamaRequest(guid);
+    sBotBuddyWakeScheduler->Forget(guid);
+    sBotBuddyReflexEngine->Forget(guid);
+    sBotBuddyPathCache->Forget(guid);
+    sBotBuddyGenerationTuner->Forget(guid);
+    sBotBuddyEndpointPool->Forget(guid);
+    sBotBuddyOllamaUsage->Forget(guid);
+    sBotBuddyNameMatcher->Remove(guid);
+    sBotBuddyChatInbox->Close(guid);
+    sBotBuddyStates->Release(guid);
+}
+
+void ReleaseBuddyBot(Player* bot)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    if (!sBotBuddyStates->Find(guid)) return;
+
+    ForgetBuddyBot(bot, "bot unenrolled");
+
+    if (PlayerbotAI* ai = sPlayerbotsMgr->GetPlayerbotAI(bot))
+        ai->ResetStrategies();
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot {} handed back to native Playerbot strategies for good.", bot->GetName());
+    }
+}
+
+// Replies can land after the bot logged out, by which time its state is gone
+static void SetBotBusy(uint64_t guid, bool busy)
+{
+    if (BotBuddyState* state = sBotBuddyStates->Find(guid))
+        state->busy = busy;
 }
 
 std::string EscapeBracesForFmt(const std::string& input) {
@@ -1658,74 +1738,455 @@ std::string EscapeBracesForFmt(const std::string& input) {
     return output;
 }
 
-void OllamaBotControlLoop::OnUpdate(uint32 /*diff*/)
+std::string ClampUtf8(const std::string& text, size_t maxBytes)
 {
-    if (!g_EnableOllamaBotControl) return;
+    if (text.size() <= maxBytes) return text;
+
+    size_t length = maxBytes;
+    while (length && (uint8(text[length]) & 0xC0) == 0x80)
+        --length;
+    return text.substr(0, length);
+}
 
-    for (auto const& itr : ObjectAccessor::GetPlayers())
+// move_to destinations of a {command, plan} reply, in the order they will be walked
+static std::vector<Position> GetReplyDestinations(const std::string& jsonStr)
+{
+    std::vector<Position> destinations;
+    nlohmann::json root = nlohmann::json::parse(jsonStr, nullptr, false);
+    if (root.is_discarded() || !root.is_object()) return destinations;
+
+    auto addStep = [&](const nlohmann::json& step) {
+        if (!step.is_object() || !step.contains("type") || step["type"] != "move_to" || !step.contains("params")) return;
+        const nlohmann::json& params = step["params"];
+        if (!params.is_object()) return;
+        if (!params.contains("x") || !params.contains("y") || !params.contains("z")) return;
+        if (!params["x"].is_number() || !params["y"].is_number() || !params["z"].is_number()) return;
+        destinations.emplace_back(params["x"].get<float>(), params["y"].get<float>(), params["z"].get<float>());
+    };
+
+    if (root.contains("command"))
+        addStep(root["command"]);
+    if (g_EnableOllamaBotControlPlans && root.contains("plan") && root["plan"].is_array())
     {
-        Player* bot = itr.second;
-        if (!bot->IsInWorld()) continue;
-        std::string botName = bot->GetName();
+        for (auto const& step : root["plan"])
+            addStep(step);
+    }
+    return destinations;
+}
+
+// Runs a {command, plan} reply once the path workers have pathed its move_to
+// destinations, so validation and MoveTo find them in the path cache instead
+// of querying the navmesh on the world tick; world thread only
+static void ExecuteBotReplyJson(Player* bot, uint64_t guid, const std::string& jsonStr, uint32 generatedTokens, bool sendState, bool pathsReady = false)
+{
+    if (!pathsReady)
+        sBotBuddyPathCache->BeginDecision(guid);
+
+    if (!pathsReady && sBotBuddyPathWorkers->Prepare(bot, GetReplyDestinations(jsonStr),
+        [guid, jsonStr, generatedTokens, sendState]() {
+            SetBotBusy(guid, false);
+            Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(guid));
+            if (bot && bot->IsInWorld() && sBotBuddyStates->Find(guid))
+                ExecuteBotReplyJson(bot, guid, jsonStr, generatedTokens, sendState, true);
+        }))
+    {
+        // No new decision while the paths are out
+        SetBotBusy(guid, true);
+        return;
+    }
 
-        // Temporary marker for testing
-        if (botName != "Ollamatest") continue;
+    sBotBuddyWakeScheduler->Sleep(guid);
 
-        // Clear the normal Playerbot AI
-        PlayerbotAI* ai = sPlayerbotsMgr->GetPlayerbotAI(bot);
-        if (ai)
+    std::string commandType;
+    ParseAndExecuteBotJson(bot, jsonStr, &commandType);
+    sBotBuddyGenerationTuner->Record(guid, commandType, generatedTokens);
+
+    if (sendState)
+    {
+        // Rebuild the prompt to include the latest command in history
+        SendBuddyBotStateToPlayer(bot, bot, BuildBotPrompt(bot));
+    }
+}
+
+// Acts on one bot's reply; world thread only
+static void ApplyBotReply(Player* bot, uint64_t guid, const std::string& llmReply, uint32 generatedTokens, bool hybrid)
+{
+    if (llmReply.empty()) return;
+
+    std::string jsonOnly = ExtractFirstJsonObject(llmReply);
+    if (jsonOnly.empty()) {
+        sBotBuddyGenerationTuner->Record(guid, "", generatedTokens);
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] No valid JSON object found in LLM reply: {}", llmReply);
+        return;
+    }
+
+    if (!hybrid) {
+        ExecuteBotReplyJson(bot, guid, jsonOnly, generatedTokens, true);
+        return;
+    }
+
+    sBotBuddyPathCache->BeginDecision(guid);
+    sBotBuddyWakeScheduler->Sleep(guid);
+
+    std::string commandType;
+    ParseAndApplyBotGoal(bot, jsonOnly, &commandType);
+    sBotBuddyGenerationTuner->Record(guid, commandType, generatedTokens);
+
+    // Rebuild the prompt to include the latest command in history
+    SendBuddyBotStateToPlayer(bot, bot, BuildBotGoalPrompt(bot));
+}
+
+static void StartBotDecision(Player* bot, uint64_t guid, const BotBuddyPrediction* prediction = nullptr)
+{
+    bool hybrid = g_EnableOllamaBotControlHybrid;
+    bool speculative = prediction != nullptr;
+    BotBuddyStageTimer snapshotTimer(BotBuddyStage::Snapshot);
+    uint32 chatSeq = sBotBuddyChatInbox->GetSeq(guid);
+    std::string prompt = hybrid ? BuildBotGoalPrompt(bot) : BuildBotPrompt(bot, prediction);
+    snapshotTimer.Stop();
+    std::string botName = bot->GetName();
+    uint32 speculation = speculative ? sBotBuddyPrefetcher->Begin(guid, *prediction) : 0;
+
+    OllamaGenerationOptions options = sBotBuddyGenerationTuner->GetOptionsFor(guid);
+    if (hybrid)
+        options.replyFormat = OllamaReplyFormat::Goal;
+    // Only this bot waits on it, so a player message may abort it (batches are left alone)
+    options.cancellable = true;
+    options.queuedAt = std::chrono::steady_clock::now();
+    sBotBuddyMetrics->OnQueued();
+
+    std::thread([guid, botName, prompt, options, hybrid, speculative, speculation, chatSeq]() {
+        OllamaReplyInfo replyInfo;
+        std::string llmReply = QueryOllamaLLM(guid, prompt, options, &replyInfo);
+        size_t promptBytes = prompt.size();
+
+        if (g_EnableOllamaBotBuddyDebug)
         {
-            ai->ClearStrategies(BOT_STATE_COMBAT);
-            ai->ClearStrategies(BOT_STATE_NON_COMBAT);
-            ai->ClearStrategies(BOT_STATE_DEAD);
-        } else {
-            continue;
+            std::string safeJson = EscapeBracesForFmt(llmReply);
+            LOG_INFO("server.loading", "[OllamaBotBuddy] LLM {}reply for '{}':\n{}", speculative ? "prefetched " : "", botName, safeJson);
         }
 
-        uint64_t guid = bot->GetGUID().GetRawValue();
-        OllamaBotState& state = ollamaBotStates[guid];
+        // The reply is acted on from the world thread, where the bot may already be gone
+        sBotBuddyWorldMailbox->Post([guid, llmReply, replyInfo, promptBytes, hybrid, speculative, speculation, chatSeq]() {
+            // A bot that logged out meanwhile only counts towards the model
+            std::vector<uint64_t> usageGuids;
+            if (sBotBuddyStates->Find(guid))
+                usageGuids.push_back(guid);
+            sBotBuddyOllamaUsage->Record(replyInfo.model, usageGuids, promptBytes, replyInfo.counters);
 
-        // Only process if not already waiting for LLM
-        if (!state.busy)
+            if (speculative)
+            {
+                // Held until the current action is over, see OnUpdate. A dropped
+                // speculation no longer owns the busy flag: the bot has moved on
+                // to a regular request.
+                if (sBotBuddyPrefetcher->Store(guid, speculation, llmReply, replyInfo.generatedTokens))
+                    SetBotBusy(guid, false);
+            }
+            else
+            {
+                // Mark ready for the next request; applying the reply may hold the bot
+                // again while its paths are computed
+                SetBotBusy(guid, false);
+
+                // The messages in the prompt are answered; after a cancel or a
+                // failure they stay for the next one
+                if (!llmReply.empty())
+                    sBotBuddyChatInbox->Acknowledge(guid, chatSeq);
+
+                Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(guid));
+                if (bot && bot->IsInWorld() && sBotBuddyStates->Find(guid))
+                {
+                    ApplyBotReply(bot, guid, llmReply, replyInfo.generatedTokens, hybrid);
+                    sBotBuddyPrefetcher->MarkActive(guid, false);
+                }
+            }
+        });
+    }).detach();
+}
+
+// Hands each {"bot": name, ...} entry of a batch reply to ParseAndExecuteBotJson
+static void ExecuteBatchReply(const std::vector<std::pair<Player*, uint64_t>>& members, const std::string& jsonStr, uint32 generatedTokens)
+{
+    nlohmann::json root = nlohmann::json::parse(jsonStr, nullptr, false);
+    if (root.is_discarded() || !root.contains("commands") || !root["commands"].is_array())
+    {
+        LOG_ERROR("server.loading", "[OllamaBotBuddy] Batch reply has no commands array: {}", jsonStr);
+        for (auto const& [bot, guid] : members)
+            sBotBuddyGenerationTuner->Record(guid, "", 0);
+        return;
+    }
+
+    auto toLower = [](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+        return text;
+    };
+
+    uint32 tokensPerBot = generatedTokens / std::max<size_t>(members.size(), 1);
+    std::vector<bool> handled(members.size(), false);
+
+    for (auto& entry : root["commands"])
+    {
+        if (!entry.is_object() || !entry.contains("bot") || !entry["bot"].is_string()) continue;
+        std::string name = toLower(entry["bot"].get<std::string>());
+
+        for (size_t i = 0; i < members.size(); ++i)
         {
-            state.busy = true;
-            state.lastRequest = time(nullptr);
+            if (handled[i] || toLower(members[i].first->GetName()) != name) continue;
+
+            handled[i] = true;
+            entry.erase("bot");
+            ExecuteBotReplyJson(members[i].first, members[i].second, entry.dump(), tokensPerBot, false);
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        if (handled[i]) continue;
+        sBotBuddyGenerationTuner->Record(members[i].second, "", 0);
+        if (g_EnableOllamaBotBuddyDebug)
+        {
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Batch reply had no command for bot {}", members[i].first->GetName());
+        }
+    }
+}
+
+static void StartBatchDecision(const std::vector<std::pair<Player*, uint64_t>>& members)
+{
+    std::vector<Player*> bots;
+    for (auto const& [bot, guid] : members)
+        bots.push_back(bot);
+
+    BotBuddyStageTimer snapshotTimer(BotBuddyStage::Snapshot);
+    std::string prompt = BuildBatchPrompt(bots);
+    snapshotTimer.Stop();
+
+    // Every bot still needs room for its own command
+    OllamaGenerationOptions options = sBotBuddyGenerationTuner->GetOptionsFor(members.front().second);
+    options.replyFormat = OllamaReplyFormat::Batch;
+    options.numPredict = 0;
+    for (auto const& [bot, guid] : members)
+    {
+        uint32 botLimit = sBotBuddyGenerationTuner->GetOptionsFor(guid).numPredict;
+        if (!botLimit)
+        {
+            options.numPredict = 0;
+            break;
+        }
+        options.numPredict += botLimit;
+    }
+
+    std::vector<uint64_t> guids;
+    for (auto const& [bot, guid] : members)
+        guids.push_back(guid);
+
+    options.queuedAt = std::chrono::steady_clock::now();
+    sBotBuddyMetrics->OnQueued();
+
+    std::thread([guids, prompt, options]() {
+        OllamaReplyInfo replyInfo;
+        // Route by the first bot so the whole party keeps landing on the same node
+        std::string llmReply = QueryOllamaLLM(guids.front(), prompt, options, &replyInfo);
+        size_t promptBytes = prompt.size();
+
+        if (g_EnableOllamaBotBuddyDebug)
+        {
+            std::string safeJson = EscapeBracesForFmt(llmReply);
+            LOG_INFO("server.loading", "[OllamaBotBuddy] LLM batch reply for {} bots:\n{}", guids.size(), safeJson);
+        }
+
+        sBotBuddyWorldMailbox->Post([guids, llmReply, replyInfo, promptBytes]() {
+            std::vector<uint64_t> usageGuids;
+            for (uint64_t guid : guids)
+                if (sBotBuddyStates->Find(guid))
+                    usageGuids.push_back(guid);
+            sBotBuddyOllamaUsage->Record(replyInfo.model, usageGuids, promptBytes, replyInfo.counters);
+
+            // Applying the reply may hold some bots again while their paths are computed
+            for (uint64_t guid : guids)
+            {
+                sBotBuddyPrefetcher->MarkActive(guid, false);
+                SetBotBusy(guid, false);
+            }
+
+            // Bots that logged out or were unenrolled while the request was running are left out
+            std::vector<std::pair<Player*, uint64_t>> members;
+            for (uint64_t guid : guids)
+            {
+                Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(guid));
+                if (bot && bot->IsInWorld() && sBotBuddyStates->Find(guid))
+                    members.emplace_back(bot, guid);
+            }
+
+            std::string jsonOnly = llmReply.empty() ? "" : ExtractFirstJsonObject(llmReply);
+            if (!jsonOnly.empty() && !members.empty())
+            {
+                ExecuteBatchReply(members, jsonOnly, replyInfo.generatedTokens);
+            }
+            else if (!llmReply.empty() && jsonOnly.empty())
+            {
+                LOG_ERROR("server.loading", "[OllamaBotBuddy] No valid JSON object found in LLM batch reply: {}", llmReply);
+            }
+        });
+    }).detach();
+}
+
+// Bots in the same group on the same map, or in the same map cell, share a batch
+static std::string GetBatchKey(Player* bot)
+{
+    if (Group* group = bot->GetGroup())
+        return fmt::format("g{}:{}:{}", group->GetGUID().GetRawValue(), bot->GetMapId(), bot->GetInstanceId());
+
+    float cellSize = std::max(1.0f, g_OllamaBotControlBatchCellSize);
+    return fmt::format("c{}:{}:{}:{}", bot->GetMapId(), bot->GetInstanceId(),
+        int32(std::floor(bot->GetPositionX() / cellSize)), int32(std::floor(bot->GetPositionY() / cellSize)));
+}
+
+void OllamaBotControlLoop::OnShutdown()
+{
+    sBotBuddyPathWorkers->Stop();
+}
 
-            std::string prompt = BuildBotPrompt(bot);
+void OllamaBotControlLoop::OnUpdate(uint32 /*diff*/)
+{
+    if (!g_EnableOllamaBotControl) return;
 
-            if (g_EnableOllamaBotBuddyDebug)
+    sBotBuddyEndpointPool->Update();
+    sBotBuddyWorldMailbox->Drain();
+    sBotBuddyMemory->Update();
+
+    // Bots that are free for a new decision this tick, grouped for batching
+    std::map<std::string, std::vector<std::pair<Player*, uint64_t>>> readyBots;
+    // Bots a player is talking to; asked first and never batched
+    std::vector<std::pair<Player*, uint64_t>> chatBots;
+
+    for (uint64_t guid : sBotBuddyEnrollment->GetOnline())
+    {
+        Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(guid));
+        if (!bot || !bot->IsInWorld()) continue;
+
+        // The Playerbot AI is attached a little after login
+        PlayerbotAI* ai = sPlayerbotsMgr->GetPlayerbotAI(bot);
+        if (!ai || !ai->IsBotAI()) continue;
+
+        BotBuddyState* found = sBotBuddyStates->Find(guid);
+        BotBuddyState& state = found ? *found : TakeOverBuddyBot(bot, ai);
+
+        // A bot still working through its last plan or goal needs no new decision yet
+        bool hybrid = g_EnableOllamaBotControlHybrid;
+        bool chatPending = HasPendingPlayerMessages(guid);
+        BotBuddyAI::UpdatePendingAction(bot);
+        // A player talking to the bot outranks walking on to an interact or attack target;
+        // plans and goals check for player messages themselves
+        if (chatPending)
+            BotBuddyAI::CancelPendingAction(bot);
+        bool actionRunning = hybrid ? sBotBuddyGoalManager->Update(bot) : sBotBuddyPlanExecutor->Update(bot);
+        actionRunning = actionRunning || BotBuddyAI::HasPendingAction(bot);
+
+        // Only think again once something happened to the bot or the fallback timer ran out
+        sBotBuddyWakeScheduler->Poll(bot);
+        if (state.actionRunning && !actionRunning)
+            sBotBuddyWakeScheduler->Wake(guid, "action finished");
+        state.actionRunning = actionRunning;
+        if (!actionRunning)
+            sBotBuddyPrefetcher->DropIfUnready(bot);
+
+        bool needsDecision = !state.busy && !actionRunning && sBotBuddyWakeScheduler->IsAwake(guid);
+
+        // Ask for the next decision while a long final step is still running
+        if (actionRunning && !state.busy && !hybrid && g_EnableOllamaBotControlPrefetch && !sBotBuddyPrefetcher->HasSpeculation(guid))
+        {
+            BotBuddyPrediction prediction;
+            const BotBuddyPlanStep* finalStep = sBotBuddyPlanExecutor->GetFinalStep(guid);
+            if (finalStep && sBotBuddyPrefetcher->Predict(bot, *finalStep, prediction) && sBotBuddyCircuitBreaker->TryAcquire())
             {
-                //LOG_INFO("server.loading", "[OllamaBotBuddy] Sending prompt for bot '{}': {}", botName, prompt);
+                state.busy = true;
+                state.lastRequest = time(nullptr);
+                StartBotDecision(bot, guid, &prediction);
             }
+        }
 
-            std::thread([bot, guid, prompt]() {
-                std::string llmReply = QueryOllamaLLM(prompt);
+        // Obvious actions are taken without asking the LLM. Skipped while on native
+        // strategies, which handle these themselves.
+        if (needsDecision && !hybrid && !chatPending && !state.nativeFallback && sBotBuddyReflexEngine->TryFire(bot))
+        {
+            sBotBuddyWakeScheduler->Sleep(guid);
+            needsDecision = false;
+        }
 
+        if (needsDecision)
+        {
+            sBotBuddyPrefetcher->MarkIdle(guid);
+
+            std::string prefetchedReply;
+            uint32 prefetchedTokens = 0;
+            if (sBotBuddyPrefetcher->TakeIfValid(bot, prefetchedReply, prefetchedTokens))
+            {
+                ApplyBotReply(bot, guid, prefetchedReply, prefetchedTokens, false);
+                sBotBuddyPrefetcher->MarkActive(guid, true);
+                needsDecision = false;
+            }
+        }
+
+        // While the breaker is open the bot plays on its native strategies instead of waiting on Ollama
+        if (needsDecision && !sBotBuddyCircuitBreaker->TryAcquire())
+        {
+            // Native strategies act without a decision; the wait is not LLM idle time
+            sBotBuddyPrefetcher->ClearIdle(guid);
+            if (!state.nativeFallback)
+            {
+                sBotBuddyGoalManager->Clear(guid);
+                ai->ResetStrategies();
+                state.nativeFallback = true;
                 if (g_EnableOllamaBotBuddyDebug)
                 {
-                    std::string safeJson = EscapeBracesForFmt(llmReply);
-                    LOG_INFO("server.loading", "[OllamaBotBuddy] LLM reply for '{}':\n{}", bot->GetName(), safeJson);
-
+                    LOG_INFO("server.loading", "[OllamaBotBuddy] Bot {} handed back to native Playerbot strategies.", bot->GetName());
                 }
+            }
+            continue;
+        }
+        if (state.nativeFallback)
+        {
+            ClearNativeStrategies(ai);
+            state.nativeFallback = false;
+        }
+        // Playerbot resets strategies on its own (group changes, GM commands); strip them again
+        else if (!hybrid && !ai->GetStrategies(BOT_STATE_NON_COMBAT).empty())
+        {
+            ClearNativeStrategies(ai);
+        }
 
-                if (!llmReply.empty())
-                {
-                    std::string jsonOnly = ExtractFirstJsonObject(llmReply);
-                    if (!jsonOnly.empty()) {
-                        ParseAndExecuteBotJson(bot, jsonOnly);
-                        
-                        // Rebuild the prompt to include the latest command in history
-                        std::string updatedPrompt = BuildBotPrompt(bot);
-                        SendBuddyBotStateToPlayer(bot, bot, updatedPrompt);
+        // Only process if not already waiting for LLM
+        if (needsDecision)
+        {
+            state.busy = true;
+            state.lastRequest = time(nullptr);
+            if (chatPending)
+            {
+                chatBots.emplace_back(bot, guid);
+                continue;
+            }
+            // Batch replies carry commands, so goals are always decided one bot at a time
+            bool batch = g_EnableOllamaBotControlBatching && !hybrid;
+            readyBots[batch ? GetBatchKey(bot) : std::to_string(guid)].emplace_back(bot, guid);
+        }
+    }
 
-                    } else {
-                        LOG_ERROR("server.loading", "[OllamaBotBuddy] No valid JSON object found in LLM reply: {}", llmReply);
-                    }
-                }
+    for (auto const& [bot, guid] : chatBots)
+        StartBotDecision(bot, guid);
+
+    for (auto& [key, members] : readyBots)
+    {
+        size_t batchSize = std::max<uint32>(g_OllamaBotControlBatchSize, 1);
+        for (size_t first = 0; first < members.size(); first += batchSize)
+        {
+            std::vector<std::pair<Player*, uint64_t>> batch(members.begin() + first,
+                members.begin() + std::min(members.size(), first + batchSize));
 
-                // Mark ready for the next request
-                ollamaBotStates[guid].busy = false;
-            }).detach();
+            if (batch.size() == 1)
+                StartBotDecision(batch.front().first, batch.front().second);
+            else
+                StartBatchDecision(batch);
         }
     }
 }
@@ -1,5 +1,8 @@
 #pragma once
 #include "ScriptMgr.h"
+#include "mod-ollama-bot-buddy_api.h"
+#include "mod-ollama-bot-buddy_state.h"
+#include <nlohmann/json.hpp>
 #include <string>
 
 class OllamaBotControlLoop : public WorldScript
@@ -7,12 +10,23 @@ class OllamaBotControlLoop : public WorldScript
 public:
     OllamaBotControlLoop();
     void OnUpdate(uint32 diff) override;
+    void OnShutdown() override;
 };
 
-void AddBotCommandHistory(Player* bot, const std::string& command);
-void AddBotReasoningHistory(Player* bot, const std::string& reasoning);
-
-std::vector<std::string> GetBotCommandHistory(Player* bot);
-std::vector<std::string> GetBotReasoningHistory(Player* bot);
+// Records a command together with the reasoning behind it
+void AddBotHistory(Player* bot, const std::string& command, const std::string& reasoning);
+std::vector<BotBuddyHistoryEntry> GetBotHistory(Player* bot);
 
 std::string EscapeBracesForFmt(const std::string& input);
+
+// Cuts at a byte limit without splitting a UTF-8 sequence
+std::string ClampUtf8(const std::string& text, size_t maxBytes);
+
+// Drops everything the module keeps for the bot, its state included; on logout
+void ForgetBuddyBot(Player* bot, const char* reason);
+
+// Unenrolled while online: forgets the bot and gives it back to its Playerbot strategies
+void ReleaseBuddyBot(Player* bot);
+
+// Validates one LLM command ({type, params}) against the bot's surroundings
+bool BuildBotControlCommand(Player* bot, const std::string& type, const nlohmann::json& params, BotControlCommand& command);
@@ -0,0 +1,25 @@
+#include "mod-ollama-bot-buddy_mailbox.h"
+
+BotBuddyWorldMailbox* BotBuddyWorldMailbox::instance()
+{
+    static BotBuddyWorldMailbox instance;
+    return &instance;
+}
+
+void BotBuddyWorldMailbox::Post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _tasks.push_back(std::move(task));
+}
+
+void BotBuddyWorldMailbox::Drain()
+{
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        tasks.swap(_tasks);
+    }
+
+    for (auto& task : tasks)
+        task();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Hands work from the LLM worker threads back to the world thread. Anything that
+// touches a Player, its motion master or its Playerbot AI goes through here.
+class BotBuddyWorldMailbox
+{
+public:
+    static BotBuddyWorldMailbox* instance();
+
+    void Post(std::function<void()> task);
+
+    // World thread only; runs everything posted since the last call
+    void Drain();
+
+private:
+    std::mutex _lock;
+    std::vector<std::function<void()>> _tasks;
+};
+
+#define sBotBuddyWorldMailbox BotBuddyWorldMailbox::instance()
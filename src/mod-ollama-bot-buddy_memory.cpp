@@ -0,0 +1,121 @@
+#include "mod-ollama-bot-buddy_memory.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+#include <fmt/format.h>
+
+// The columns are VARCHAR(255)
+static constexpr size_t MEMORY_MAX_TEXT = 255;
+
+BotBuddyMemoryStore* BotBuddyMemoryStore::instance()
+{
+    static BotBuddyMemoryStore instance;
+    return &instance;
+}
+
+void BotBuddyMemoryStore::Load(uint64_t botGuid)
+{
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    if (!state) return;
+
+    if (!g_EnableOllamaBotControlMemory)
+    {
+        state->memoryLoaded = true;
+        return;
+    }
+
+    _loads.AddCallback(CharacterDatabase.AsyncQuery(fmt::format(
+        "SELECT seq, command, reasoning FROM mod_ollama_bot_buddy_memory WHERE guid = {} ORDER BY seq",
+        ObjectGuid(botGuid).GetCounter()))
+        .WithCallback([this, botGuid](QueryResult result) { OnLoaded(botGuid, std::move(result)); }));
+}
+
+void BotBuddyMemoryStore::OnLoaded(uint64_t botGuid, QueryResult result)
+{
+    // Logged out before the answer came back, or a quick relog loaded it already
+    BotBuddyState* state = sBotBuddyStates->Find(botGuid);
+    if (!state || state->memoryLoaded) return;
+
+    BotBuddyRing<BotBuddyHistoryEntry> history(BOT_BUDDY_HISTORY_SIZE);
+    if (result)
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            state->memorySeq = fields[0].Get<uint32>() + 1;
+            history.Push({ fields[1].Get<std::string>(), fields[2].Get<std::string>() });
+        } while (result->NextRow());
+    }
+
+    // Whatever the bot did since enrollment goes after the stored entries
+    state->history.ForEach([&history](const BotBuddyHistoryEntry& entry) { history.Push(entry); });
+    state->history = std::move(history);
+
+    state->memoryLoaded = true;
+    for (const BotBuddyHistoryEntry& entry : state->memoryBacklog)
+        Record(*state, entry);
+    state->memoryBacklog.clear();
+    _loaded++;
+}
+
+void BotBuddyMemoryStore::Record(BotBuddyState& state, const BotBuddyHistoryEntry& entry)
+{
+    if (!g_EnableOllamaBotControlMemory) return;
+
+    if (!state.memoryLoaded)
+    {
+        // Sequence numbers continue from the stored ones, which are not known yet
+        state.memoryBacklog.push_back(entry);
+        return;
+    }
+
+    PendingRow row;
+    row.guid = ObjectGuid(state.guid).GetCounter();
+    row.seq = state.memorySeq++;
+    row.command = ClampUtf8(entry.command, MEMORY_MAX_TEXT);
+    row.reasoning = ClampUtf8(entry.reasoning, MEMORY_MAX_TEXT);
+    _pending.push_back(std::move(row));
+}
+
+void BotBuddyMemoryStore::Update()
+{
+    _loads.ProcessReadyCallbacks();
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < _nextFlush) return;
+
+    _nextFlush = now + std::chrono::seconds(g_OllamaBotControlMemoryFlushSeconds);
+    Flush();
+}
+
+void BotBuddyMemoryStore::Flush()
+{
+    if (_pending.empty()) return;
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    for (PendingRow& row : _pending)
+    {
+        // The slot makes the table a ring: each bot keeps at most
+        // BOT_BUDDY_HISTORY_SIZE rows
+        std::string command = row.command;
+        std::string reasoning = row.reasoning;
+        CharacterDatabase.EscapeString(command);
+        CharacterDatabase.EscapeString(reasoning);
+        trans->Append("REPLACE INTO mod_ollama_bot_buddy_memory (guid, slot, seq, command, reasoning) VALUES ({}, {}, {}, '{}', '{}')",
+            row.guid, row.seq % BOT_BUDDY_HISTORY_SIZE, row.seq, command, reasoning);
+    }
+    CharacterDatabase.CommitTransaction(trans);
+
+    _rowsWritten += _pending.size();
+    _transactions++;
+    _pending.clear();
+}
+
+std::vector<std::string> BotBuddyMemoryStore::GetSummary() const
+{
+    return {
+        fmt::format("memory: loaded={} queued={} written={} transactions={}",
+            _loaded, _pending.size(), _rowsWritten, _transactions)
+    };
+}
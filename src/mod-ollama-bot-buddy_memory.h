@@ -0,0 +1,54 @@
+#pragma once
+#include "mod-ollama-bot-buddy_state.h"
+#include "QueryCallbackProcessor.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Keeps each bot's command history, with the reasoning of every command, in the
+// mod_ollama_bot_buddy_memory characters table, so a bot remembers what it was
+// doing across relogs and restarts. The table is a ring of
+// BOT_BUDDY_HISTORY_SIZE rows per bot, written by slot. Nothing here
+// waits on the database: loads are async queries answered on a later world
+// tick, and writes are queued and committed as one async transaction per flush
+// interval. World thread only.
+class BotBuddyMemoryStore
+{
+public:
+    static BotBuddyMemoryStore* instance();
+
+    // On enrollment. Entries recorded before the rows arrive count as newer.
+    void Load(uint64_t botGuid);
+
+    // The entry is already in the state's ring; this only persists it
+    void Record(BotBuddyState& state, const BotBuddyHistoryEntry& entry);
+
+    // World tick: runs finished loads and flushes on the timer
+    void Update();
+
+    // Commits everything queued in one transaction
+    void Flush();
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    struct PendingRow
+    {
+        uint32 guid = 0;
+        uint32 seq = 0;
+        std::string command;
+        std::string reasoning;
+    };
+
+    void OnLoaded(uint64_t botGuid, QueryResult result);
+
+    QueryCallbackProcessor _loads;
+    std::vector<PendingRow> _pending;
+    std::chrono::steady_clock::time_point _nextFlush;
+
+    uint64 _loaded = 0;
+    uint64 _rowsWritten = 0;
+    uint64 _transactions = 0;
+};
+
+#define sBotBuddyMemory BotBuddyMemoryStore::instance()
@@ -0,0 +1,172 @@
+#include "mod-ollama-bot-buddy_metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+
+static const char* const StageNames[] = {
+    "snapshot", "render", "queue wait", "connect", "first byte", "generation", "parse", "validate", "execute"
+};
+static_assert(std::size(StageNames) == size_t(BotBuddyStage::Count), "every stage needs a name");
+
+uint32 BotBuddyLatencyHistogram::GetBucket(uint64 value)
+{
+    if (value < SUB_BUCKETS)
+        return uint32(value);
+
+    // Highest set bit picks the power of two, the next SUB_BUCKET_BITS bits the sub-bucket
+    uint32 exponent = 63 - uint32(__builtin_clzll(value));
+    uint32 shift = exponent - SUB_BUCKET_BITS;
+    uint32 sub = uint32(value >> shift) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+}
+
+uint64 BotBuddyLatencyHistogram::GetBucketUpperEdge(uint32 bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    uint32 shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64 sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void BotBuddyLatencyHistogram::Record(uint64 micros)
+{
+    _buckets[GetBucket(micros)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64 max = _max.load(std::memory_order_relaxed);
+    while (micros > max && !_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {}
+}
+
+uint64 BotBuddyLatencyHistogram::GetPercentile(double percentile) const
+{
+    // Buckets are read one by one while others may still be recording; the
+    // answer is as of roughly now, which is all a report needs
+    uint64 total = 0;
+    for (auto const& bucket : _buckets)
+        total += bucket.load(std::memory_order_relaxed);
+    if (!total) return 0;
+
+    uint64 rank = std::max<uint64>(1, uint64(std::ceil(total * percentile / 100.0)));
+    uint64 seen = 0;
+    for (uint32 i = 0; i < BUCKETS; ++i)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(GetBucketUpperEdge(i), GetMax());
+    }
+    return GetMax();
+}
+
+BotBuddyMetrics* BotBuddyMetrics::instance()
+{
+    static BotBuddyMetrics instance;
+    return &instance;
+}
+
+void BotBuddyMetrics::Record(BotBuddyStage stage, std::chrono::steady_clock::duration elapsed)
+{
+    RecordMicros(stage, uint64(std::max<int64>(0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())));
+}
+
+void BotBuddyMetrics::RecordMicros(BotBuddyStage stage, uint64 micros)
+{
+    _stages[size_t(stage)].Record(micros);
+}
+
+std::vector<std::string> BotBuddyMetrics::GetSummary() const
+{
+    std::vector<std::string> lines;
+    lines.push_back(fmt::format("requests: in flight={} queued={}",
+        _inFlight.load(std::memory_order_relaxed), _queued.load(std::memory_order_relaxed)));
+
+    for (size_t i = 0; i < _stages.size(); ++i)
+    {
+        BotBuddyLatencyHistogram const& histogram = _stages[i];
+        if (!histogram.GetCount()) continue;
+
+        lines.push_back(fmt::format("{}: n={} p50={:.2f}ms p95={:.2f}ms p99={:.2f}ms max={:.2f}ms",
+            StageNames[i], histogram.GetCount(),
+            histogram.GetPercentile(50) / 1000.0, histogram.GetPercentile(95) / 1000.0,
+            histogram.GetPercentile(99) / 1000.0, histogram.GetMax() / 1000.0));
+    }
+    return lines;
+}
+
+// Typical bytes per token of English text under the BPE vocabularies Ollama
+// models use; only the prompt cache estimate depends on it
+static constexpr double PROMPT_BYTES_PER_TOKEN = 4.0;
+
+BotBuddyOllamaUsage* BotBuddyOllamaUsage::instance()
+{
+    static BotBuddyOllamaUsage instance;
+    return &instance;
+}
+
+void BotBuddyOllamaUsage::Totals::Add(size_t bytes, const OllamaRequestCounters& counters, uint32 share)
+{
+    requests++;
+    // Cancelled and failed requests, and streams cut before the final line, report nothing
+    if (!counters.reported) return;
+
+    reported++;
+    promptBytes += bytes / share;
+    promptEvalCount += counters.promptEvalCount / share;
+    promptEvalDuration += counters.promptEvalDuration / share;
+    evalCount += counters.evalCount / share;
+    evalDuration += counters.evalDuration / share;
+    loadDuration += counters.loadDuration / share;
+    totalDuration += counters.totalDuration / share;
+}
+
+std::string BotBuddyOllamaUsage::Totals::Format() const
+{
+    auto perSecond = [](uint64 tokens, uint64 nanoseconds) {
+        return nanoseconds ? tokens * 1e9 / nanoseconds : 0.0;
+    };
+    auto averageMs = [this](uint64 nanoseconds) {
+        return reported ? nanoseconds / 1e6 / reported : 0.0;
+    };
+
+    // Ollama only counts the prompt tokens it had to evaluate, so the share of
+    // the prompt that is missing from that count was served from the KV cache
+    double promptTokens = promptBytes / PROMPT_BYTES_PER_TOKEN;
+    double cached = promptTokens > 0.0 ? std::clamp(1.0 - promptEvalCount / promptTokens, 0.0, 1.0) * 100.0 : 0.0;
+
+    return fmt::format("requests={} reported={} generation={:.1f} tok/s prompt={:.1f} tok/s "
+        "per request {} prompt + {} generated tokens, prompt cached~{:.0f}% load={:.0f}ms total={:.0f}ms",
+        requests, reported, perSecond(evalCount, evalDuration), perSecond(promptEvalCount, promptEvalDuration),
+        reported ? promptEvalCount / reported : 0, reported ? evalCount / reported : 0, cached,
+        averageMs(loadDuration), averageMs(totalDuration));
+}
+
+void BotBuddyOllamaUsage::Record(const std::string& model, const std::vector<uint64_t>& botGuids, size_t promptBytes, const OllamaRequestCounters& counters)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _byModel[model].Add(promptBytes, counters, 1);
+    for (uint64_t guid : botGuids)
+        _byBot[guid].Add(promptBytes, counters, uint32(botGuids.size()));
+}
+
+void BotBuddyOllamaUsage::Forget(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _byBot.erase(botGuid);
+}
+
+std::vector<std::string> BotBuddyOllamaUsage::GetModelSummary()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    std::vector<std::string> lines;
+    for (auto const& [model, totals] : _byModel)
+        lines.push_back(fmt::format("model {}: {}", model, totals.Format()));
+    return lines;
+}
+
+std::string BotBuddyOllamaUsage::GetBotSummary(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    auto it = _byBot.find(botGuid);
+    return it != _byBot.end() ? it->second.Format() : "";
+}
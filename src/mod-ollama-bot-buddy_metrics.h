@@ -0,0 +1,152 @@
+#pragma once
+#include "Define.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Where the time of one decision goes, in pipeline order
+enum class BotBuddyStage : uint8
+{
+    Snapshot,     // bot state, surroundings and memory turned into the prompt
+    Render,       // request body built and serialized
+    QueueWait,    // decision dispatched until the HTTP request starts
+    Connect,      // TCP connect to Ollama
+    FirstByte,    // request start until the first response byte
+    Generation,   // first response byte until the stream ends or is cut
+    Parse,        // reply JSON parsed and its fields read
+    Validate,     // ValidateBotControlCommand
+    Execute,      // HandleBotControlCommand
+    Count
+};
+
+// Latency histogram with log-linear buckets in the style of HdrHistogram:
+// each power of two is split into 8 sub-buckets, so any value is reported
+// within 12.5% of its true size, from a microsecond to hours, in fixed memory.
+// Recording is a relaxed atomic increment, safe from any thread.
+class BotBuddyLatencyHistogram
+{
+public:
+    void Record(uint64 micros);
+
+    uint64 GetCount() const { return _count.load(std::memory_order_relaxed); }
+    uint64 GetMax() const { return _max.load(std::memory_order_relaxed); }
+    // Upper edge of the bucket holding the percentile, in microseconds
+    uint64 GetPercentile(double percentile) const;
+
+private:
+    static constexpr uint32 SUB_BUCKET_BITS = 3;
+    static constexpr uint32 SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr uint32 BUCKETS = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    static uint32 GetBucket(uint64 value);
+    static uint64 GetBucketUpperEdge(uint32 bucket);
+
+    std::array<std::atomic<uint64>, BUCKETS> _buckets {};
+    std::atomic<uint64> _count { 0 };
+    std::atomic<uint64> _max { 0 };
+};
+
+class BotBuddyMetrics
+{
+public:
+    static BotBuddyMetrics* instance();
+
+    void Record(BotBuddyStage stage, std::chrono::steady_clock::duration elapsed);
+    void RecordMicros(BotBuddyStage stage, uint64 micros);
+
+    // A decision was handed to its request thread / the thread picked it up
+    void OnQueued() { _queued.fetch_add(1, std::memory_order_relaxed); }
+    void OnDequeued() { _queued.fetch_sub(1, std::memory_order_relaxed); }
+    // An HTTP request to Ollama started / ended
+    void OnSent() { _inFlight.fetch_add(1, std::memory_order_relaxed); }
+    void OnFinished() { _inFlight.fetch_sub(1, std::memory_order_relaxed); }
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    std::array<BotBuddyLatencyHistogram, size_t(BotBuddyStage::Count)> _stages;
+    std::atomic<int64> _queued { 0 };
+    std::atomic<int64> _inFlight { 0 };
+};
+
+#define sBotBuddyMetrics BotBuddyMetrics::instance()
+
+// Records the time until Stop or the end of the scope, whichever comes first
+class BotBuddyStageTimer
+{
+public:
+    explicit BotBuddyStageTimer(BotBuddyStage stage) : _stage(stage), _start(std::chrono::steady_clock::now()) {}
+    ~BotBuddyStageTimer() { Stop(); }
+
+    BotBuddyStageTimer(BotBuddyStageTimer const&) = delete;
+    BotBuddyStageTimer& operator=(BotBuddyStageTimer const&) = delete;
+
+    void Stop()
+    {
+        if (_stopped) return;
+        _stopped = true;
+        sBotBuddyMetrics->Record(_stage, std::chrono::steady_clock::now() - _start);
+    }
+
+private:
+    BotBuddyStage _stage;
+    std::chrono::steady_clock::time_point _start;
+    bool _stopped = false;
+};
+
+// Ollama's own counters from the final line of a reply; durations in nanoseconds
+struct OllamaRequestCounters
+{
+    bool reported = false;          // the final line arrived
+    uint32 promptEvalCount = 0;     // prompt tokens evaluated, cached ones excluded
+    uint64 promptEvalDuration = 0;
+    uint32 evalCount = 0;           // tokens generated
+    uint64 evalDuration = 0;
+    uint64 loadDuration = 0;        // loading the model, near zero when it is resident
+    uint64 totalDuration = 0;
+};
+
+// Adds up Ollama's counters per model and per bot, to tell how fast the fleet
+// generates and how much of each prompt the KV cache saves. Recorded from the
+// request threads, read by .buddy stats.
+class BotBuddyOllamaUsage
+{
+public:
+    static BotBuddyOllamaUsage* instance();
+
+    // A batch reply is shared evenly among its bots. World thread, so a bot
+    // that logged out while its request ran is not counted again after Forget.
+    void Record(const std::string& model, const std::vector<uint64_t>& botGuids, size_t promptBytes, const OllamaRequestCounters& counters);
+    void Forget(uint64_t botGuid);
+
+    std::vector<std::string> GetModelSummary();
+    // Empty when the bot made no request yet
+    std::string GetBotSummary(uint64_t botGuid);
+
+private:
+    struct Totals
+    {
+        uint64 requests = 0;
+        uint64 reported = 0;
+        uint64 promptBytes = 0;
+        uint64 promptEvalCount = 0;
+        uint64 promptEvalDuration = 0;
+        uint64 evalCount = 0;
+        uint64 evalDuration = 0;
+        uint64 loadDuration = 0;
+        uint64 totalDuration = 0;
+
+        void Add(size_t promptBytes, const OllamaRequestCounters& counters, uint32 share);
+        std::string Format() const;
+    };
+
+    std::mutex _lock;
+    std::unordered_map<std::string, Totals> _byModel;
+    std::unordered_map<uint64_t, Totals> _byBot;
+};
+
+#define sBotBuddyOllamaUsage BotBuddyOllamaUsage::instance()
@@ -0,0 +1,135 @@
+#include "mod-ollama-bot-buddy_names.h"
+#include <algorithm>
+#include <cctype>
+#include <queue>
+
+BotBuddyNameMatcher* BotBuddyNameMatcher::instance()
+{
+    static BotBuddyNameMatcher instance;
+    return &instance;
+}
+
+static uint8 LowerByte(char c)
+{
+    return uint8(std::tolower(uint8(c)));
+}
+
+void BotBuddyNameMatcher::Add(uint64_t botGuid, const std::string& name)
+{
+    if (name.empty()) return;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    auto it = _names.find(botGuid);
+    if (it != _names.end() && it->second == name) return;
+
+    _names[botGuid] = name;
+    Rebuild();
+}
+
+void BotBuddyNameMatcher::Remove(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_names.erase(botGuid)) return;
+    Rebuild();
+}
+
+void BotBuddyNameMatcher::Rebuild()
+{
+    auto automaton = std::make_shared<Automaton>();
+
+    // Only bytes that occur in some name get their own column
+    for (auto const& [guid, name] : _names)
+    {
+        for (char c : name)
+        {
+            uint8& byteClass = automaton->byteClass[LowerByte(c)];
+            if (!byteClass)
+                byteClass = uint8(automaton->classCount++);
+        }
+    }
+
+    uint32 classCount = automaton->classCount;
+    std::vector<int32>& next = automaton->next;
+    next.assign(classCount, -1);
+    automaton->matches.emplace_back();
+
+    // Trie of the lowercased names
+    for (auto const& [guid, name] : _names)
+    {
+        uint32 botIndex = uint32(automaton->guids.size());
+        automaton->guids.push_back(guid);
+
+        int32 node = 0;
+        for (char c : name)
+        {
+            uint32 byteClass = automaton->byteClass[LowerByte(c)];
+            if (next[node * classCount + byteClass] < 0)
+            {
+                next[node * classCount + byteClass] = int32(automaton->matches.size());
+                next.resize(next.size() + classCount, -1);
+                automaton->matches.emplace_back();
+            }
+            node = next[node * classCount + byteClass];
+        }
+        automaton->matches[node].push_back(botIndex);
+    }
+
+    // Breadth-first over the trie: fill in failure transitions so every
+    // (node, class) pair has a target, and merge in the matches of the
+    // longest proper suffix that is also a trie node
+    std::vector<int32> fail(automaton->matches.size(), 0);
+    std::queue<int32> pending;
+    for (uint32 byteClass = 0; byteClass < classCount; ++byteClass)
+    {
+        int32& target = next[byteClass];
+        if (target < 0)
+            target = 0;
+        else
+            pending.push(target);
+    }
+
+    while (!pending.empty())
+    {
+        int32 node = pending.front();
+        pending.pop();
+
+        for (uint32 byteClass = 0; byteClass < classCount; ++byteClass)
+        {
+            int32 fallback = next[fail[node] * classCount + byteClass];
+            int32& target = next[node * classCount + byteClass];
+            if (target < 0)
+            {
+                target = fallback;
+                continue;
+            }
+
+            fail[target] = fallback;
+            std::vector<uint32> const& inherited = automaton->matches[fallback];
+            automaton->matches[target].insert(automaton->matches[target].end(), inherited.begin(), inherited.end());
+            pending.push(target);
+        }
+    }
+
+    std::atomic_store(&_automaton, std::shared_ptr<const Automaton>(std::move(automaton)));
+}
+
+std::vector<uint64_t> BotBuddyNameMatcher::FindMentioned(const std::string& message) const
+{
+    std::vector<uint64_t> mentioned;
+    std::shared_ptr<const Automaton> automaton = std::atomic_load(&_automaton);
+    if (!automaton || automaton->guids.empty()) return mentioned;
+
+    std::vector<bool> seen(automaton->guids.size(), false);
+    int32 node = 0;
+    for (char c : message)
+    {
+        node = automaton->next[node * automaton->classCount + automaton->byteClass[LowerByte(c)]];
+        for (uint32 botIndex : automaton->matches[node])
+        {
+            if (seen[botIndex]) continue;
+            seen[botIndex] = true;
+            mentioned.push_back(automaton->guids[botIndex]);
+        }
+    }
+    return mentioned;
+}
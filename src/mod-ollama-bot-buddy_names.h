@@ -0,0 +1,43 @@
+#pragma once
+#include "Define.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Finds which LLM-controlled bots a chat message mentions. Holds an
+// Aho-Corasick automaton over the lowercased names of enrolled bots, rebuilt
+// whenever one is added or removed and swapped in atomically, so a message is
+// scanned once, in O(message length), without taking a lock.
+class BotBuddyNameMatcher
+{
+public:
+    static BotBuddyNameMatcher* instance();
+
+    // No-op when the bot is already enrolled under that name
+    void Add(uint64_t botGuid, const std::string& name);
+    void Remove(uint64_t botGuid);
+
+    // Any thread; each mentioned bot is listed once
+    std::vector<uint64_t> FindMentioned(const std::string& message) const;
+
+private:
+    struct Automaton
+    {
+        std::array<uint8, 256> byteClass {};    // 0 for bytes that occur in no name
+        uint32 classCount = 1;
+        std::vector<int32> next;                // node * classCount + class
+        std::vector<std::vector<uint32>> matches;  // bot indexes ending at each node
+        std::vector<uint64_t> guids;
+    };
+
+    void Rebuild();
+
+    std::mutex _lock;
+    std::unordered_map<uint64_t, std::string> _names;
+    std::shared_ptr<const Automaton> _automaton;
+};
+
+#define sBotBuddyNameMatcher BotBuddyNameMatcher::instance()
@@ -0,0 +1,316 @@
+#include "mod-ollama-bot-buddy_pathing.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_mailbox.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include "Map.h"
+#include "MapDefines.h"
+#include "MMapFactory.h"
+#include "MMapMgr.h"
+#include "ObjectAccessor.h"
+#include "Log.h"
+#include <algorithm>
+#include <shared_mutex>
+#include <fmt/format.h>
+
+static constexpr size_t PATH_CACHE_ENTRIES = 4;
+static constexpr float PATH_CACHE_TOLERANCE = 2.0f;
+// Looser at the start: a plan's next leg begins wherever the bot stopped,
+// which is only within the arrival distance of the previous destination
+static constexpr float PATH_CACHE_START_TOLERANCE = 4.0f;
+
+static constexpr int PATH_MAX_POLYS = 256;
+static constexpr int PATH_MAX_POINTS = 74;
+
+BotBuddyPathCache* BotBuddyPathCache::instance()
+{
+    static BotBuddyPathCache instance;
+    return &instance;
+}
+
+// With PathCache.Seconds = 0 entries never expire by time; BeginDecision
+// clears them instead
+static void EraseExpired(std::deque<BotBuddyValidatedPath>& entries, std::chrono::steady_clock::time_point now)
+{
+    if (!g_OllamaBotControlPathCacheSeconds) return;
+
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+        [&](const BotBuddyValidatedPath& entry) { return now >= entry.expires; }), entries.end());
+}
+
+void BotBuddyPathCache::BeginDecision(uint64_t botGuid)
+{
+    if (!g_OllamaBotControlPathCacheSeconds)
+        _paths.erase(botGuid);
+}
+
+std::deque<BotBuddyValidatedPath>& BotBuddyPathCache::GetEntries(uint64_t botGuid)
+{
+    std::deque<BotBuddyValidatedPath>& entries = _paths[botGuid];
+    EraseExpired(entries, std::chrono::steady_clock::now());
+    return entries;
+}
+
+void BotBuddyPathCache::Insert(std::deque<BotBuddyValidatedPath>& entries, BotBuddyValidatedPath path)
+{
+    path.expires = std::chrono::steady_clock::now() + std::chrono::seconds(g_OllamaBotControlPathCacheSeconds);
+
+    while (entries.size() >= PATH_CACHE_ENTRIES)
+        entries.pop_front();
+    entries.push_back(std::move(path));
+}
+
+// Bots that stopped moving would otherwise keep their last paths forever
+void BotBuddyPathCache::PruneExpired()
+{
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = _paths.begin(); it != _paths.end();)
+    {
+        EraseExpired(it->second, now);
+        if (it->second.empty())
+            it = _paths.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool BotBuddyPathCache::Has(Player* bot, const Position& start, const Position& destination)
+{
+    for (const BotBuddyValidatedPath& entry : GetEntries(bot->GetGUID().GetRawValue()))
+    {
+        if (entry.destination.GetExactDist(&destination) <= PATH_CACHE_TOLERANCE &&
+            entry.start.GetExactDist(&start) <= PATH_CACHE_START_TOLERANCE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const BotBuddyValidatedPath& BotBuddyPathCache::Get(Player* bot, float x, float y, float z)
+{
+    std::deque<BotBuddyValidatedPath>& entries = GetEntries(bot->GetGUID().GetRawValue());
+    for (const BotBuddyValidatedPath& entry : entries)
+    {
+        if (entry.destination.GetExactDist(x, y, z) <= PATH_CACHE_TOLERANCE &&
+            entry.start.GetExactDist(bot) <= PATH_CACHE_START_TOLERANCE)
+        {
+            return entry;
+        }
+    }
+
+    PathGenerator generator(bot);
+    generator.CalculatePath(x, y, z, false);
+
+    BotBuddyValidatedPath path;
+    path.start = bot->GetPosition();
+    path.destination = Position(x, y, z);
+    path.type = generator.GetPathType();
+    path.points = generator.GetPath();
+    Insert(entries, std::move(path));
+    return entries.back();
+}
+
+void BotBuddyPathCache::Store(uint64_t botGuid, BotBuddyValidatedPath path)
+{
+    PruneExpired();
+    Insert(_paths[botGuid], std::move(path));
+}
+
+void BotBuddyPathCache::Forget(uint64_t botGuid)
+{
+    _paths.erase(botGuid);
+}
+
+BotBuddyPathWorkers* BotBuddyPathWorkers::instance()
+{
+    static BotBuddyPathWorkers instance;
+    return &instance;
+}
+
+// Straight path over the navmesh. Returns false when the answer is not known
+// here (a point is off the mesh or its tile is not loaded) and the world thread
+// should fall back to PathGenerator.
+static bool QueryPath(dtNavMeshQuery* query, const Position& start, const Position& destination, BotBuddyValidatedPath& path)
+{
+    dtQueryFilter filter;
+    filter.setIncludeFlags(NAV_GROUND | NAV_WATER);
+    filter.setExcludeFlags(0);
+
+    // Detour works in y-up coordinates
+    float const extents[3] = { 3.0f, 5.0f, 3.0f };
+    float const startPoint[3] = { start.GetPositionY(), start.GetPositionZ(), start.GetPositionX() };
+    float const endPoint[3] = { destination.GetPositionY(), destination.GetPositionZ(), destination.GetPositionX() };
+
+    dtPolyRef startRef = 0;
+    dtPolyRef endRef = 0;
+    float startNearest[3];
+    float endNearest[3];
+    if (dtStatusFailed(query->findNearestPoly(startPoint, extents, &filter, &startRef, startNearest)) || !startRef)
+        return false;
+    if (dtStatusFailed(query->findNearestPoly(endPoint, extents, &filter, &endRef, endNearest)) || !endRef)
+        return false;
+
+    path.start = start;
+    path.destination = destination;
+
+    dtPolyRef polys[PATH_MAX_POLYS];
+    int polyCount = 0;
+    if (dtStatusFailed(query->findPath(startRef, endRef, startNearest, endNearest, &filter, polys, &polyCount, PATH_MAX_POLYS)) || !polyCount)
+    {
+        path.type = PATHFIND_NOPATH;
+        return true;
+    }
+
+    float points[PATH_MAX_POINTS * 3];
+    int pointCount = 0;
+    if (dtStatusFailed(query->findStraightPath(startNearest, endNearest, polys, polyCount, points, nullptr, nullptr, &pointCount, PATH_MAX_POINTS)) || !pointCount)
+    {
+        path.type = PATHFIND_NOPATH;
+        return true;
+    }
+
+    path.type = polys[polyCount - 1] == endRef ? PATHFIND_NORMAL : PATHFIND_INCOMPLETE;
+    path.points.reserve(pointCount);
+    for (int i = 0; i < pointCount; ++i)
+        path.points.emplace_back(points[i * 3 + 2], points[i * 3], points[i * 3 + 1]);
+    return true;
+}
+
+bool BotBuddyPathWorkers::Prepare(Player* bot, const std::vector<Position>& destinations, std::function<void()> then)
+{
+    if (!g_OllamaBotControlPathWorkers || destinations.empty()) return false;
+
+    // Instance maps are destroyed when they empty, possibly while a job for
+    // them is queued; the world thread paths those itself
+    Map* map = bot->GetMap();
+    if (!map || map->Instanceable()) return false;
+
+    Job job;
+    job.botGuid = bot->GetGUID().GetRawValue();
+    job.mapId = bot->GetMapId();
+    job.map = map;
+
+    Position start = bot->GetPosition();
+    for (const Position& destination : destinations)
+    {
+        if (!sBotBuddyPathCache->Has(bot, start, destination))
+            job.legs.emplace_back(start, destination);
+        start = destination;
+    }
+    if (job.legs.empty()) return false;
+
+    job.then = std::move(then);
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_stopping) return false;
+        _queued += job.legs.size();
+        _jobs.push_back(std::move(job));
+    }
+    StartWorkers();
+    _wake.notify_one();
+    return true;
+}
+
+void BotBuddyPathWorkers::StartWorkers()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    while (!_stopping && _workers.size() < g_OllamaBotControlPathWorkers)
+        _workers.emplace_back([this]() { Run(); });
+}
+
+void BotBuddyPathWorkers::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+        _jobs.clear();
+    }
+    _wake.notify_all();
+
+    for (std::thread& worker : _workers)
+        worker.join();
+    _workers.clear();
+}
+
+void BotBuddyPathWorkers::Run()
+{
+    // One query object per map, owned by this thread; Detour queries are not
+    // safe to share. Rebound when the map's navmesh was reloaded.
+    struct MapQuery
+    {
+        dtNavMesh const* navMesh = nullptr;
+        dtNavMeshQuery* query = nullptr;
+    };
+    std::unordered_map<uint32, MapQuery> queries;
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            _wake.wait(guard, [this]() { return _stopping || !_jobs.empty(); });
+            if (_stopping) break;
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<BotBuddyValidatedPath> paths;
+        {
+            // Tiles are loaded and unloaded by the map threads under this lock
+            std::shared_lock<std::shared_mutex> mmapGuard(job.map->GetMMapLock());
+
+            dtNavMesh const* navMesh = MMAP::MMapFactory::createOrGetMMapMgr()->GetNavMesh(job.mapId);
+            MapQuery& mapQuery = queries[job.mapId];
+            if (navMesh && mapQuery.navMesh != navMesh)
+            {
+                if (!mapQuery.query)
+                    mapQuery.query = dtAllocNavMeshQuery();
+                mapQuery.navMesh = navMesh;
+                if (dtStatusFailed(mapQuery.query->init(navMesh, 1024)))
+                {
+                    LOG_ERROR("server.loading", "[OllamaBotBuddy] Could not create a navmesh query for map {}", job.mapId);
+                    mapQuery.navMesh = nullptr;
+                }
+            }
+
+            for (auto const& [start, destination] : job.legs)
+            {
+                BotBuddyValidatedPath path;
+                if (navMesh && mapQuery.navMesh == navMesh && QueryPath(mapQuery.query, start, destination, path))
+                    paths.push_back(std::move(path));
+                else
+                    _unresolved++;
+            }
+        }
+        _computed += paths.size();
+        _totalMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+        uint64_t botGuid = job.botGuid;
+        uint32 mapId = job.mapId;
+        sBotBuddyWorldMailbox->Post([botGuid, mapId, paths = std::move(paths), then = std::move(job.then)]() mutable {
+            // Paths from another map are worthless if the bot was teleported meanwhile
+            Player* bot = ObjectAccessor::FindConnectedPlayer(ObjectGuid(botGuid));
+            if (bot && bot->IsInWorld() && bot->GetMapId() == mapId)
+            {
+                for (BotBuddyValidatedPath& path : paths)
+                    sBotBuddyPathCache->Store(botGuid, std::move(path));
+            }
+            then();
+        });
+    }
+
+    for (auto& [mapId, mapQuery] : queries)
+        dtFreeNavMeshQuery(mapQuery.query);
+}
+
+std::vector<std::string> BotBuddyPathWorkers::GetSummary()
+{
+    uint64 computed = _computed;
+    return {
+        fmt::format("path workers={} queued={} computed={} unresolved={} avg={:.2f}ms",
+            g_OllamaBotControlPathWorkers, uint64(_queued), computed, uint64(_unresolved),
+            computed ? double(_totalMicros) / computed / 1000.0 : 0.0)
+    };
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "Player.h"
+#include "PathGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Map;
+
+// Navmesh path for one move_to destination. Validation and BotBuddyAI::MoveTo
+// share it, so a destination is pathed once and the bot walks exactly that path.
+struct BotBuddyValidatedPath
+{
+    Position start;
+    Position destination;
+    PathType type = PATHFIND_BLANK;
+    Movement::PointsArray points;
+    std::chrono::steady_clock::time_point expires;
+};
+
+// The last few destinations each bot was sent to. World thread only.
+class BotBuddyPathCache
+{
+public:
+    static BotBuddyPathCache* instance();
+
+    // A new reply is about to be validated. With PathCache.Seconds = 0 paths
+    // are only shared between the validation and the execution of one reply,
+    // so the bot's earlier ones are dropped here.
+    void BeginDecision(uint64_t botGuid);
+
+    // Reuses a path with a matching start and end, otherwise runs PathGenerator
+    // inline. The reference is valid until the next Get or Store.
+    const BotBuddyValidatedPath& Get(Player* bot, float x, float y, float z);
+    bool Has(Player* bot, const Position& start, const Position& destination);
+    void Store(uint64_t botGuid, BotBuddyValidatedPath path);
+    void Forget(uint64_t botGuid);
+
+private:
+    std::deque<BotBuddyValidatedPath>& GetEntries(uint64_t botGuid);
+    void Insert(std::deque<BotBuddyValidatedPath>& entries, BotBuddyValidatedPath path);
+    void PruneExpired();
+
+    std::unordered_map<uint64_t, std::deque<BotBuddyValidatedPath>> _paths;
+};
+
+#define sBotBuddyPathCache BotBuddyPathCache::instance()
+
+// Answers the navmesh queries for a reply's move_to destinations on worker
+// threads, each with its own dtNavMeshQuery, and hands the paths back through
+// the world mailbox. The world tick then only looks them up in the path cache.
+// Workers hold the map's mmap lock while they query, like PathGenerator does,
+// so map threads cannot load or unload tiles under them.
+class BotBuddyPathWorkers
+{
+public:
+    static BotBuddyPathWorkers* instance();
+
+    // World thread. Destinations are walked in order, each one starting where
+    // the previous one ended. Returns false without queueing anything when the
+    // cache already has every path, workers are disabled or the bot is in an
+    // instance; otherwise `then` runs from the world mailbox once the paths
+    // are stored.
+    bool Prepare(Player* bot, const std::vector<Position>& destinations, std::function<void()> then);
+
+    // Drops queued jobs and joins the workers; on world shutdown
+    void Stop();
+
+    std::vector<std::string> GetSummary();
+
+private:
+    struct Job
+    {
+        uint64_t botGuid = 0;
+        uint32 mapId = 0;
+        Map* map = nullptr;  // a continent: never unloaded, unlike instances
+        std::vector<std::pair<Position, Position>> legs;  // start, destination
+        std::function<void()> then;
+    };
+
+    void StartWorkers();
+    void Run();
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::deque<Job> _jobs;
+    std::vector<std::thread> _workers;
+    bool _stopping = false;
+
+    std::atomic<uint64> _queued { 0 };
+    std::atomic<uint64> _computed { 0 };
+    std::atomic<uint64> _unresolved { 0 };
+    std::atomic<uint64> _totalMicros { 0 };
+};
+
+#define sBotBuddyPathWorkers BotBuddyPathWorkers::instance()
@@ -0,0 +1,196 @@
+#include "mod-ollama-bot-buddy_plan.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_api.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "mod-ollama-bot-buddy_handler.h"
+#include "Player.h"
+#include "MoveSpline.h"
+#include "Log.h"
+#include <fmt/format.h>
+
+// Movement and combat take a moment to start after the command is issued
+static constexpr std::chrono::milliseconds STEP_SETTLE_TIME { 1000 };
+
+BotBuddyPlanExecutor* BotBuddyPlanExecutor::instance()
+{
+    static BotBuddyPlanExecutor instance;
+    return &instance;
+}
+
+bool BotBuddyPlanExecutor::Start(Player* bot, std::vector<BotBuddyPlanStep> steps, const std::string& reasoning)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    Cancel(guid, "replaced by a new plan");
+    if (steps.empty()) return false;
+
+    ActivePlan& plan = _plans[guid];
+    plan.pending.assign(steps.begin(), steps.end());
+    plan.reasoning = reasoning;
+    _started++;
+
+    if (!RunNextStep(bot, plan))
+    {
+        Finish(guid, false);
+        return false;
+    }
+    return true;
+}
+
+bool BotBuddyPlanExecutor::RunNextStep(Player* bot, ActivePlan& plan)
+{
+    plan.current = std::move(plan.pending.front());
+    plan.pending.pop_front();
+    plan.stepStarted = std::chrono::steady_clock::now();
+    plan.stepIndex++;
+    _stepsRun++;
+
+    std::string command = nlohmann::json{{"type", plan.current.type}, {"params", plan.current.params}}.dump();
+    AddBotHistory(bot, command, plan.stepIndex == 1 ? plan.reasoning : fmt::format("plan step {}: {}", plan.stepIndex, plan.reasoning));
+
+    BotControlCommand command;
+    if (!BuildBotControlCommand(bot, plan.current.type, plan.current.params, command))
+        return false;
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Bot {} plan step {}: {}", bot->GetName(), plan.stepIndex, plan.current.type);
+    }
+
+    return HandleBotControlCommand(bot, command);
+}
+
+BotBuddyPlanExecutor::StepStatus BotBuddyPlanExecutor::GetStepStatus(Player* bot, const ActivePlan& plan) const
+{
+    auto elapsed = std::chrono::steady_clock::now() - plan.stepStarted;
+    if (g_OllamaBotControlPlanStepTimeoutSeconds && elapsed > std::chrono::seconds(g_OllamaBotControlPlanStepTimeoutSeconds))
+        return StepStatus::Failed;
+
+    const BotBuddyPlanStep& step = plan.current;
+    if (step.type == "move_to")
+    {
+        float x = step.params.value("x", 0.0f);
+        float y = step.params.value("y", 0.0f);
+        float z = step.params.value("z", 0.0f);
+        if (bot->GetExactDist(x, y, z) <= g_OllamaBotControlPlanArrivalDistance)
+            return StepStatus::Done;
+
+        // The spline ended short of the destination, so whatever comes next
+        // would run from the wrong place
+        if (elapsed > STEP_SETTLE_TIME && bot->movespline->Finalized())
+            return StepStatus::Failed;
+
+        return StepStatus::Running;
+    }
+
+    // Still walking into range; the interaction or attack has not happened yet
+    if ((step.type == "interact" || step.type == "attack") && BotBuddyAI::HasPendingAction(bot))
+        return StepStatus::Running;
+
+    if (step.type == "attack")
+    {
+        if (elapsed < STEP_SETTLE_TIME) return StepStatus::Running;
+
+        Unit* victim = bot->GetVictim();
+        return (!victim || !victim->IsAlive()) ? StepStatus::Done : StepStatus::Running;
+    }
+
+    // Everything else completes when it is issued
+    return StepStatus::Done;
+}
+
+bool BotBuddyPlanExecutor::Update(Player* bot)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    auto it = _plans.find(guid);
+    if (it == _plans.end()) return false;
+
+    ActivePlan& plan = it->second;
+
+    if (bot->IsInCombat() && plan.current.type != "attack")
+    {
+        Cancel(guid, "entered combat");
+        return false;
+    }
+
+    if (HasPendingPlayerMessages(guid))
+    {
+        Cancel(guid, "player spoke to the bot");
+        return false;
+    }
+
+    switch (GetStepStatus(bot, plan))
+    {
+        case StepStatus::Running:
+            return true;
+        case StepStatus::Failed:
+            Finish(guid, false);
+            return false;
+        case StepStatus::Done:
+            break;
+    }
+
+    if (plan.pending.empty())
+    {
+        Finish(guid, true);
+        return false;
+    }
+
+    if (!RunNextStep(bot, plan))
+    {
+        Finish(guid, false);
+        return false;
+    }
+    return true;
+}
+
+bool BotBuddyPlanExecutor::HasPlan(uint64_t botGuid) const
+{
+    return _plans.find(botGuid) != _plans.end();
+}
+
+const BotBuddyPlanStep* BotBuddyPlanExecutor::GetFinalStep(uint64_t botGuid) const
+{
+    auto it = _plans.find(botGuid);
+    if (it == _plans.end() || !it->second.pending.empty()) return nullptr;
+    return &it->second.current;
+}
+
+void BotBuddyPlanExecutor::Cancel(uint64_t botGuid, const char* reason)
+{
+    auto it = _plans.find(botGuid);
+    if (it == _plans.end()) return;
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Plan preempted at step {} ({} left): {}", it->second.stepIndex, it->second.pending.size(), reason);
+    }
+
+    _plans.erase(it);
+    _preempted++;
+}
+
+void BotBuddyPlanExecutor::Finish(uint64_t botGuid, bool success)
+{
+    auto it = _plans.find(botGuid);
+    if (it == _plans.end()) return;
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Plan {} at step {} ({} left)", success ? "completed" : "failed", it->second.stepIndex, it->second.pending.size());
+    }
+
+    _plans.erase(it);
+    if (success)
+        _completed++;
+    else
+        _failed++;
+}
+
+std::vector<std::string> BotBuddyPlanExecutor::GetSummary() const
+{
+    double stepsPerPlan = _started ? double(_stepsRun) / _started : 0.0;
+    return {
+        fmt::format("plans: started={} completed={} failed={} preempted={} running={} steps={} ({:.2f} steps per LLM decision)",
+            _started, _completed, _failed, _preempted, _plans.size(), _stepsRun, stepsPerPlan)
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Define.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+
+// One command of an LLM plan, kept as raw JSON so it is validated against the
+// world as it is when the step starts rather than when the reply arrived
+struct BotBuddyPlanStep
+{
+    std::string type;
+    nlohmann::json params;
+};
+
+// Walks a bot through a short ordered plan ("move there, talk to him, accept
+// the quest") on world ticks. A step finishes when its precondition for the
+// next one holds (arrived, target dead) and fails on timeout or when it cannot
+// run. Combat and player chat preempt the plan so the LLM can react.
+// World thread only.
+class BotBuddyPlanExecutor
+{
+public:
+    static BotBuddyPlanExecutor* instance();
+
+    // Replaces any running plan and starts the first step right away. Every
+    // step goes into the history with the reply's reasoning.
+    // Returns false when the first step could not be executed.
+    bool Start(Player* bot, std::vector<BotBuddyPlanStep> steps, const std::string& reasoning);
+
+    // Advances the bot's plan; returns true while it is still running
+    bool Update(Player* bot);
+
+    bool HasPlan(uint64_t botGuid) const;
+
+    // The running step when nothing is queued after it, nullptr otherwise
+    const BotBuddyPlanStep* GetFinalStep(uint64_t botGuid) const;
+    void Cancel(uint64_t botGuid, const char* reason);
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    struct ActivePlan
+    {
+        std::deque<BotBuddyPlanStep> pending;
+        BotBuddyPlanStep current;
+        std::chrono::steady_clock::time_point stepStarted;
+        uint32 stepIndex = 0;
+        std::string reasoning;
+    };
+
+    enum class StepStatus
+    {
+        Running,
+        Done,
+        Failed
+    };
+
+    bool RunNextStep(Player* bot, ActivePlan& plan);
+    StepStatus GetStepStatus(Player* bot, const ActivePlan& plan) const;
+    void Finish(uint64_t botGuid, bool success);
+
+    std::unordered_map<uint64_t, ActivePlan> _plans;
+
+    uint64 _started = 0;
+    uint64 _completed = 0;
+    uint64 _failed = 0;
+    uint64 _preempted = 0;
+    uint64 _stepsRun = 0;
+};
+
+#define sBotBuddyPlanExecutor BotBuddyPlanExecutor::instance()
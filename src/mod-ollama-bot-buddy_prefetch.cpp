@@ -0,0 +1,183 @@
+#include "mod-ollama-bot-buddy_prefetch.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_plan.h"
+#include "mod-ollama-bot-buddy_llm.h"
+#include "mod-ollama-bot-buddy_state.h"
+#include "mod-ollama-bot-buddy_handler.h"
+#include "Player.h"
+#include "Log.h"
+#include <fmt/format.h>
+
+// A speculative reply this old describes a world that has moved on
+static constexpr std::chrono::seconds SPECULATION_MAX_AGE { 60 };
+
+BotBuddyPrefetcher* BotBuddyPrefetcher::instance()
+{
+    static BotBuddyPrefetcher instance;
+    return &instance;
+}
+
+bool BotBuddyPrefetcher::Predict(Player* bot, const BotBuddyPlanStep& step, BotBuddyPrediction& prediction) const
+{
+    if (step.type == "move_to")
+    {
+        prediction.type = step.type;
+        prediction.x = step.params.value("x", 0.0f);
+        prediction.y = step.params.value("y", 0.0f);
+        prediction.z = step.params.value("z", 0.0f);
+        return bot->GetExactDist(prediction.x, prediction.y, prediction.z) >= g_OllamaBotControlPrefetchMinDistance;
+    }
+
+    if (step.type == "attack")
+    {
+        Unit* victim = bot->GetVictim();
+        if (!victim || !victim->IsAlive()) return false;
+
+        // Fights are fought roughly where they start
+        prediction.type = step.type;
+        prediction.x = bot->GetPositionX();
+        prediction.y = bot->GetPositionY();
+        prediction.z = bot->GetPositionZ();
+        prediction.target = victim->GetGUID().GetCounter();
+        prediction.targetName = victim->GetName();
+        return true;
+    }
+
+    return false;
+}
+
+uint32 BotBuddyPrefetcher::Begin(uint64_t botGuid, const BotBuddyPrediction& prediction)
+{
+    Speculation& speculation = _speculations[botGuid];
+    speculation = Speculation();
+    speculation.prediction = prediction;
+    speculation.ticket = ++_nextTicket;
+    speculation.started = std::chrono::steady_clock::now();
+    _started++;
+    return speculation.ticket;
+}
+
+bool BotBuddyPrefetcher::Store(uint64_t botGuid, uint32 ticket, const std::string& reply, uint32 generatedTokens)
+{
+    auto it = _speculations.find(botGuid);
+    if (it == _speculations.end() || it->second.ticket != ticket) return false;
+
+    it->second.ready = true;
+    it->second.reply = reply;
+    it->second.generatedTokens = generatedTokens;
+    return true;
+}
+
+void BotBuddyPrefetcher::Discard(uint64_t botGuid)
+{
+    auto it = _speculations.find(botGuid);
+    if (it == _speculations.end()) return;
+
+    // The speculation held the bot busy until its reply came back
+    if (!it->second.ready)
+    {
+        CancelOllamaRequest(botGuid);
+        if (BotBuddyState* state = sBotBuddyStates->Find(botGuid))
+            state->busy = false;
+    }
+    _speculations.erase(it);
+    _discarded++;
+}
+
+bool BotBuddyPrefetcher::DropIfUnready(Player* bot)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    auto it = _speculations.find(guid);
+    if (it == _speculations.end() || it->second.ready) return false;
+
+    // Waiting for it would hold the bot up, and by the time it came back it
+    // would be measured against a snapshot that no longer holds
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Discarding prefetched decision for bot {}: not ready", bot->GetName());
+    }
+    Discard(guid);
+    return true;
+}
+
+bool BotBuddyPrefetcher::HasSpeculation(uint64_t botGuid) const
+{
+    return _speculations.find(botGuid) != _speculations.end();
+}
+
+bool BotBuddyPrefetcher::TakeIfValid(Player* bot, std::string& reply, uint32& generatedTokens)
+{
+    if (DropIfUnready(bot)) return false;
+
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    auto it = _speculations.find(guid);
+    if (it == _speculations.end()) return false;
+
+    Speculation speculation = std::move(it->second);
+    _speculations.erase(it);
+
+    BotBuddyPrediction const& prediction = speculation.prediction;
+    const char* mismatch = nullptr;
+    if (speculation.reply.empty())
+        mismatch = "no reply";
+    else if (std::chrono::steady_clock::now() - speculation.started > SPECULATION_MAX_AGE)
+        mismatch = "too old";
+    else if (HasPendingPlayerMessages(guid))
+        mismatch = "a player spoke to the bot";
+    else if (bot->GetExactDist(prediction.x, prediction.y, prediction.z) > g_OllamaBotControlPrefetchTolerance)
+        mismatch = "bot is not where it was predicted to be";
+    else if (prediction.type == "attack" && bot->IsInCombat())
+        mismatch = "still in combat";
+
+    if (mismatch)
+    {
+        _discarded++;
+        if (g_EnableOllamaBotBuddyDebug)
+        {
+            LOG_INFO("server.loading", "[OllamaBotBuddy] Discarding prefetched decision for bot {}: {}", bot->GetName(), mismatch);
+        }
+        return false;
+    }
+
+    _committed++;
+    reply = std::move(speculation.reply);
+    generatedTokens = speculation.generatedTokens;
+    return true;
+}
+
+void BotBuddyPrefetcher::MarkIdle(uint64_t botGuid)
+{
+    _idleSince.emplace(botGuid, std::chrono::steady_clock::now());
+}
+
+void BotBuddyPrefetcher::MarkActive(uint64_t botGuid, bool prefetched)
+{
+    auto it = _idleSince.find(botGuid);
+    if (it == _idleSince.end()) return;
+
+    auto idleMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - it->second).count();
+    _idleSince.erase(it);
+
+    IdleStats& stats = prefetched ? _prefetchedIdle : _regularIdle;
+    stats.count++;
+    stats.totalMs += uint64(idleMs);
+}
+
+void BotBuddyPrefetcher::ClearIdle(uint64_t botGuid)
+{
+    _idleSince.erase(botGuid);
+}
+
+std::vector<std::string> BotBuddyPrefetcher::GetSummary() const
+{
+    double regularAvg = _regularIdle.count ? double(_regularIdle.totalMs) / _regularIdle.count : 0.0;
+    double prefetchedAvg = _prefetchedIdle.count ? double(_prefetchedIdle.totalMs) / _prefetchedIdle.count : 0.0;
+    double savedSeconds = regularAvg > prefetchedAvg ? (regularAvg - prefetchedAvg) * _prefetchedIdle.count / 1000.0 : 0.0;
+
+    return {
+        fmt::format("prefetch: started={} committed={} discarded={} in flight={}",
+            _started, _committed, _discarded, _speculations.size()),
+        fmt::format("idle before next action: regular avg {:.0f} ms (n={}), prefetched avg {:.0f} ms (n={}), ~{:.1f} s idle removed",
+            regularAvg, _regularIdle.count, prefetchedAvg, _prefetchedIdle.count, savedSeconds)
+    };
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "Define.h"
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+struct BotBuddyPlanStep;
+
+// Where the bot is expected to be once its current action is over
+struct BotBuddyPrediction
+{
+    std::string type;   // "move_to" or "attack"
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    uint32 target = 0;
+    std::string targetName;
+};
+
+// Speculative prefetch: while a long final plan step runs (a long move_to or a
+// fight), the next decision is requested early from the predicted state. When
+// the step is over the stored reply is used only if the bot ended up where it
+// was predicted to; otherwise it is thrown away and a normal request goes out.
+// Also measures how long bots stand idle between finishing an action and
+// starting the next one. World thread only.
+class BotBuddyPrefetcher
+{
+public:
+    static BotBuddyPrefetcher* instance();
+
+    // False when the step is too short to be worth a speculative request
+    bool Predict(Player* bot, const BotBuddyPlanStep& step, BotBuddyPrediction& prediction) const;
+
+    // Returns the ticket its reply has to be stored with
+    uint32 Begin(uint64_t botGuid, const BotBuddyPrediction& prediction);
+    // False when the speculation was dropped meanwhile; the reply is stale then
+    bool Store(uint64_t botGuid, uint32 ticket, const std::string& reply, uint32 generatedTokens);
+    bool HasSpeculation(uint64_t botGuid) const;
+
+    // Hands back the stored reply when the real state still matches the
+    // prediction; the speculation is dropped either way
+    bool TakeIfValid(Player* bot, std::string& reply, uint32& generatedTokens);
+
+    // Drops a speculation still waiting on Ollama, cancelling its request and
+    // freeing the bot for a regular one. For when the action it was made for
+    // is already over.
+    bool DropIfUnready(Player* bot);
+    void Discard(uint64_t botGuid);
+
+    // Idle accounting: from the moment a bot needs a decision until the next
+    // action is applied. ClearIdle forgets the wait without counting it, for
+    // bots that act without a decision (native fallback, chat orders).
+    void MarkIdle(uint64_t botGuid);
+    void MarkActive(uint64_t botGuid, bool prefetched);
+    void ClearIdle(uint64_t botGuid);
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    struct Speculation
+    {
+        BotBuddyPrediction prediction;
+        uint32 ticket = 0;
+        std::chrono::steady_clock::time_point started;
+        bool ready = false;
+        std::string reply;
+        uint32 generatedTokens = 0;
+    };
+
+    struct IdleStats
+    {
+        uint64 count = 0;
+        uint64 totalMs = 0;
+    };
+
+    std::unordered_map<uint64_t, Speculation> _speculations;
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> _idleSince;
+
+    uint32 _nextTicket = 0;
+    uint64 _started = 0;
+    uint64 _committed = 0;
+    uint64 _discarded = 0;
+    IdleStats _regularIdle;
+    IdleStats _prefetchedIdle;
+};
+
+#define sBotBuddyPrefetcher BotBuddyPrefetcher::instance()
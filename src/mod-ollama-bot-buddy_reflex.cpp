@@ -0,0 +1,186 @@
+#include "mod-ollama-bot-buddy_reflex.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_loop.h"
+#include "Creature.h"
+#include "GameObject.h"
+#include "Group.h"
+#include "Map.h"
+#include "ObjectMgr.h"
+#include "QuestDef.h"
+#include "Log.h"
+#include <fmt/format.h>
+
+static constexpr std::chrono::seconds REFLEX_RETRY_TIME { 10 };
+
+static const char* const ReflexRuleNames[] = { "fight_back", "turn_in_quest", "loot" };
+
+BotBuddyReflexEngine* BotBuddyReflexEngine::instance()
+{
+    static BotBuddyReflexEngine instance;
+    return &instance;
+}
+
+bool BotBuddyReflexEngine::TryFire(Player* bot)
+{
+    if (!g_EnableOllamaBotControlReflexes || !bot || !bot->IsAlive()) return false;
+
+    if (g_EnableOllamaBotControlReflexFightBack && TryFightBack(bot)) return true;
+    if (g_EnableOllamaBotControlReflexTurnIn && TryTurnInQuest(bot)) return true;
+    if (g_EnableOllamaBotControlReflexLoot && TryLoot(bot)) return true;
+    return false;
+}
+
+void BotBuddyReflexEngine::Forget(uint64_t botGuid)
+{
+    _lastFired.erase(botGuid);
+}
+
+bool BotBuddyReflexEngine::IsRepeat(uint64_t botGuid, BotBuddyReflexRule rule, uint32 target) const
+{
+    auto it = _lastFired.find(botGuid);
+    if (it == _lastFired.end()) return false;
+
+    LastFired const& last = it->second;
+    return last.rule == rule && last.target == target && std::chrono::steady_clock::now() - last.at < REFLEX_RETRY_TIME;
+}
+
+bool BotBuddyReflexEngine::Fire(Player* bot, BotBuddyReflexRule rule, uint32 target, const BotControlCommand& command, const std::string& history)
+{
+    _lastFired[bot->GetGUID().GetRawValue()] = { rule, target, std::chrono::steady_clock::now() };
+
+    RuleStats& stats = _stats[size_t(rule)];
+    stats.hits++;
+
+    // Keep it in the command history so the next prompt knows what happened
+    AddBotHistory(bot, history, fmt::format("reflex ({})", ReflexRuleNames[size_t(rule)]));
+
+    bool result = HandleBotControlCommand(bot, command);
+    if (!result)
+        stats.failures++;
+
+    if (g_EnableOllamaBotBuddyDebug)
+    {
+        LOG_INFO("server.loading", "[OllamaBotBuddy] Reflex {} fired for bot {} (target {}): {}",
+            ReflexRuleNames[size_t(rule)], bot->GetName(), target, result ? "ok" : "failed");
+    }
+
+    // A failed command still counts as handled for this tick; the retry guard
+    // hands the next decision to the LLM
+    return true;
+}
+
+bool BotBuddyReflexEngine::TryFightBack(Player* bot)
+{
+    if (!bot->IsInCombat()) return false;
+
+    // Already hitting something alive: nothing to decide
+    if (Unit* victim = bot->GetVictim())
+        if (victim->IsAlive())
+            return false;
+
+    Unit* closest = nullptr;
+    for (Unit* attacker : bot->getAttackers())
+    {
+        if (!attacker || !attacker->IsAlive() || !bot->IsValidAttackTarget(attacker)) continue;
+        if (!closest || bot->GetDistance(attacker) < bot->GetDistance(closest))
+            closest = attacker;
+    }
+    if (!closest) return false;
+
+    uint32 target = closest->GetGUID().GetCounter();
+    if (IsRepeat(bot->GetGUID().GetRawValue(), BotBuddyReflexRule::FightBack, target)) return false;
+
+    // A player attacker may share its counter with a creature nearby
+    BotControlCommand command = BotBuddyCmd::Attack{ target, closest->GetGUID() };
+    return Fire(bot, BotBuddyReflexRule::FightBack, target, command,
+        fmt::format("{{\"params\":{{\"guid\":{}}},\"type\":\"attack\"}}", target));
+}
+
+bool BotBuddyReflexEngine::TryTurnInQuest(Player* bot)
+{
+    if (bot->IsInCombat()) return false;
+
+    std::vector<uint32> readyQuests;
+    for (uint8 slot = 0; slot < MAX_QUEST_LOG_SIZE; ++slot)
+    {
+        uint32 questId = bot->GetQuestSlotQuestId(slot);
+        if (!questId) continue;
+        if (bot->GetQuestStatus(questId) != QUEST_STATUS_COMPLETE || bot->GetQuestRewardStatus(questId)) continue;
+
+        Quest const* quest = sObjectMgr->GetQuestTemplate(questId);
+        if (quest && bot->CanRewardQuest(quest, false))
+            readyQuests.push_back(questId);
+    }
+    if (readyQuests.empty()) return false;
+
+    Map* map = bot->GetMap();
+    if (!map) return false;
+
+    // Same reach TurnInQuest uses to find the quest ender
+    auto isEnderInReach = [&](uint32 questId) {
+        for (auto const& pair : map->GetCreatureBySpawnIdStore())
+        {
+            Creature* creature = pair.second;
+            if (creature && bot->IsWithinDistInMap(creature, INTERACTION_DISTANCE) && creature->hasInvolvedQuest(questId))
+                return true;
+        }
+        for (auto const& pair : map->GetGameObjectBySpawnIdStore())
+        {
+            GameObject* go = pair.second;
+            if (go && bot->IsWithinDistInMap(go, INTERACTION_DISTANCE) && go->hasInvolvedQuest(questId))
+                return true;
+        }
+        return false;
+    };
+
+    for (uint32 questId : readyQuests)
+    {
+        if (IsRepeat(bot->GetGUID().GetRawValue(), BotBuddyReflexRule::TurnInQuest, questId)) continue;
+        if (!isEnderInReach(questId)) continue;
+
+        BotControlCommand command = BotBuddyCmd::TurnInQuest{ questId };
+        return Fire(bot, BotBuddyReflexRule::TurnInQuest, questId, command,
+            fmt::format("{{\"params\":{{\"id\":{}}},\"type\":\"turn_in_quest\"}}", questId));
+    }
+    return false;
+}
+
+bool BotBuddyReflexEngine::TryLoot(Player* bot)
+{
+    if (bot->IsInCombat()) return false;
+
+    Map* map = bot->GetMap();
+    if (!map) return false;
+
+    // The same corpses the prompt would mark DEAD (LOOTABLE)
+    bool anyLootable = false;
+    for (auto const& pair : map->GetCreatureBySpawnIdStore())
+    {
+        Creature* c = pair.second;
+        if (!c || !c->isDead() || !c->hasLootRecipient() || c->loot.isLooted()) continue;
+        if (!bot->IsWithinDistInMap(c, g_OllamaBotControlReflexLootRange)) continue;
+        if (c->GetLootRecipient() != bot && !(c->GetLootRecipientGroup() && bot->GetGroup() == c->GetLootRecipientGroup())) continue;
+
+        anyLootable = true;
+        break;
+    }
+    if (!anyLootable) return false;
+
+    // Loot has no target: Playerbot picks the corpses, so the guard is on the
+    // rule itself rather than on one corpse the command never looks at
+    if (IsRepeat(bot->GetGUID().GetRawValue(), BotBuddyReflexRule::Loot, 0)) return false;
+
+    BotControlCommand command = BotBuddyCmd::Loot{};
+    return Fire(bot, BotBuddyReflexRule::Loot, 0, command, "{\"params\":{},\"type\":\"loot\"}");
+}
+
+std::vector<std::string> BotBuddyReflexEngine::GetSummary() const
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < _stats.size(); ++i)
+    {
+        lines.push_back(fmt::format("reflex {}: hits={} failed={}",
+            ReflexRuleNames[i], _stats[i].hits, _stats[i].failures));
+    }
+    return lines;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "mod-ollama-bot-buddy_api.h"
+#include <array>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class BotBuddyReflexRule
+{
+    FightBack,
+    TurnInQuest,
+    Loot,
+    Count
+};
+
+// Deterministic rules for decisions the prompt would only spell out for the
+// model anyway: fight back when attacked, hand in a finished quest at an NPC
+// in reach, loot our own corpses. Runs before a prompt is built; when a rule
+// fires its command goes straight to HandleBotControlCommand and the LLM call
+// is skipped. World thread only.
+class BotBuddyReflexEngine
+{
+public:
+    static BotBuddyReflexEngine* instance();
+
+    // Tries the enabled rules in priority order; true when one fired
+    bool TryFire(Player* bot);
+    void Forget(uint64_t botGuid);
+
+    std::vector<std::string> GetSummary() const;
+
+private:
+    struct RuleStats
+    {
+        uint64 hits = 0;
+        uint64 failures = 0;
+    };
+
+    struct LastFired
+    {
+        BotBuddyReflexRule rule = BotBuddyReflexRule::Count;
+        uint32 target = 0;
+        std::chrono::steady_clock::time_point at;
+    };
+
+    bool TryFightBack(Player* bot);
+    bool TryTurnInQuest(Player* bot);
+    bool TryLoot(Player* bot);
+
+    // Same rule on the same target again too soon means the last attempt did
+    // not take; leave it to the LLM instead of looping
+    bool IsRepeat(uint64_t botGuid, BotBuddyReflexRule rule, uint32 target) const;
+    bool Fire(Player* bot, BotBuddyReflexRule rule, uint32 target, const BotControlCommand& command, const std::string& history);
+
+    std::array<RuleStats, size_t(BotBuddyReflexRule::Count)> _stats;
+    std::unordered_map<uint64_t, LastFired> _lastFired;
+};
+
+#define sBotBuddyReflexEngine BotBuddyReflexEngine::instance()
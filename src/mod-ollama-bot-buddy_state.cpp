@@ -0,0 +1,54 @@
+#include "mod-ollama-bot-buddy_state.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include <algorithm>
+
+BotBuddyStateMap* BotBuddyStateMap::instance()
+{
+    static BotBuddyStateMap instance;
+    return &instance;
+}
+
+BotBuddyState& BotBuddyStateMap::Acquire(uint64_t botGuid)
+{
+    auto it = _index.find(botGuid);
+    if (it != _index.end())
+        return _slots[it->second];
+
+    uint32 slot;
+    if (!_freeSlots.empty())
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else
+    {
+        slot = uint32(_slots.size());
+        _slots.emplace_back();
+    }
+
+    BotBuddyState& state = _slots[slot];
+    state = BotBuddyState();
+    state.guid = botGuid;
+    state.history = BotBuddyRing<BotBuddyHistoryEntry>(BOT_BUDDY_HISTORY_SIZE);
+    state.messages = BotBuddyRing<BotBuddyChatMessage>(std::max<uint32>(g_OllamaBotControlChatQueueSize, 1));
+
+    _index.emplace(botGuid, slot);
+    return state;
+}
+
+void BotBuddyStateMap::Release(uint64_t botGuid)
+{
+    auto it = _index.find(botGuid);
+    if (it == _index.end()) return;
+
+    // Drop the strings now rather than when the slot is next handed out
+    _slots[it->second] = BotBuddyState();
+    _freeSlots.push_back(it->second);
+    _index.erase(it);
+}
+
+BotBuddyState* BotBuddyStateMap::Find(uint64_t botGuid)
+{
+    auto it = _index.find(botGuid);
+    return it == _index.end() ? nullptr : &_slots[it->second];
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "Define.h"
+#include <array>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Fixed-capacity FIFO that overwrites its oldest entry when full. Slots are
+// allocated once, so pushing never allocates beyond the entry itself.
+template <typename T>
+class BotBuddyRing
+{
+public:
+    explicit BotBuddyRing(size_t capacity = 0) : _slots(capacity) {}
+
+    size_t Capacity() const { return _slots.size(); }
+    size_t Size() const { return _count; }
+    bool Empty() const { return _count == 0; }
+    bool Full() const { return _count == _slots.size(); }
+
+    T const& Front() const { return _slots[_head]; }
+
+    void Push(T value)
+    {
+        if (_slots.empty()) return;
+        if (Full())
+            PopFront();
+        _slots[(_head + _count) % _slots.size()] = std::move(value);
+        ++_count;
+    }
+
+    T PopFront()
+    {
+        T value = std::move(_slots[_head]);
+        _slots[_head] = T();
+        _head = (_head + 1) % _slots.size();
+        --_count;
+        return value;
+    }
+
+    // Oldest first
+    template <typename Fn>
+    void ForEach(Fn&& fn) const
+    {
+        for (size_t i = 0; i < _count; ++i)
+            fn(_slots[(_head + i) % _slots.size()]);
+    }
+
+private:
+    std::vector<T> _slots;
+    size_t _head = 0;
+    size_t _count = 0;
+};
+
+// Commands the prompt shows the model, and the database keeps
+static constexpr size_t BOT_BUDDY_HISTORY_SIZE = 5;
+
+// One command the bot carried out and why: the reasoning of the reply it came
+// from, or a short note for reflexes and player orders
+struct BotBuddyHistoryEntry
+{
+    std::string command;
+    std::string reasoning;
+};
+
+struct BotBuddyChatMessage
+{
+    std::string sender;
+    std::string text;
+    uint32 seq = 0;
+};
+
+// Everything the module keeps per LLM-controlled bot, in one place. Every
+// writer runs on the world thread (replies come back through the world
+// mailbox), so nothing here is locked.
+struct BotBuddyState
+{
+    uint64_t guid = 0;
+
+    // Decision loop
+    bool busy = false;           // a request or a deferred reply is out for this bot
+    time_t lastRequest = 0;
+    bool nativeFallback = false;
+    bool actionRunning = false;
+
+    // Shown back to the model in the next prompt
+    BotBuddyRing<BotBuddyHistoryEntry> history;
+
+    // Persistence of the history, see BotBuddyMemoryStore
+    bool memoryLoaded = false;
+    uint32 memorySeq = 0;
+    std::vector<BotBuddyHistoryEntry> memoryBacklog;  // recorded before the load finished
+
+    // Player messages waiting for a reply that answers them, see BotBuddyChatInbox
+    BotBuddyRing<BotBuddyChatMessage> messages;
+    uint32 messageSeq = 0;
+};
+
+// One BotBuddyState per enrolled bot. Slots are reused after logout, so memory
+// follows the number of bots enrolled at once rather than every GUID ever
+// seen, and a bot keeps the same slot while it is online. World thread only.
+class BotBuddyStateMap
+{
+public:
+    static BotBuddyStateMap* instance();
+
+    // Returns the bot's state, creating it on first use
+    BotBuddyState& Acquire(uint64_t botGuid);
+    void Release(uint64_t botGuid);
+
+    // nullptr for bots that are not enrolled
+    BotBuddyState* Find(uint64_t botGuid);
+
+    size_t GetCount() const { return _index.size(); }
+
+private:
+    std::deque<BotBuddyState> _slots;  // deque: growing never moves a live state
+    std::vector<uint32> _freeSlots;
+    std::unordered_map<uint64_t, uint32> _index;
+};
+
+#define sBotBuddyStates BotBuddyStateMap::instance()
@@ -0,0 +1,115 @@
+#include "mod-ollama-bot-buddy_wake.h"
+#include "mod-ollama-bot-buddy_config.h"
+#include "mod-ollama-bot-buddy_handler.h"
+#include "Player.h"
+#include "MoveSpline.h"
+#include "Log.h"
+#include <fmt/format.h>
+
+BotBuddyWakeScheduler* BotBuddyWakeScheduler::instance()
+{
+    static BotBuddyWakeScheduler instance;
+    return &instance;
+}
+
+void BotBuddyWakeScheduler::WakeLocked(WakeState& state, const char* reason)
+{
+    if (state.awake) return;
+
+    state.awake = true;
+    _wakesByReason[reason]++;
+}
+
+void BotBuddyWakeScheduler::Wake(uint64_t botGuid, const char* reason)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    auto it = _bots.find(botGuid);
+    if (it != _bots.end())
+        WakeLocked(it->second, reason);
+}
+
+void BotBuddyWakeScheduler::Sleep(uint64_t botGuid)
+{
+    if (!g_EnableOllamaBotControlWake) return;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    WakeState& state = _bots[botGuid];
+    state.awake = false;
+    state.fallbackAt = std::chrono::steady_clock::now() + std::chrono::seconds(g_OllamaBotControlWakeFallbackSeconds);
+}
+
+void BotBuddyWakeScheduler::Poll(Player* bot)
+{
+    uint64_t guid = bot->GetGUID().GetRawValue();
+    bool moving = !bot->movespline->Finalized();
+    bool inCombat = bot->IsInCombat();
+    bool chat = HasPendingPlayerMessages(guid);
+
+    std::lock_guard<std::mutex> guard(_lock);
+    auto it = _bots.find(guid);
+    if (it == _bots.end()) return;
+
+    WakeState& state = it->second;
+    if (state.wasMoving && !moving)
+        WakeLocked(state, "movement finished");
+    if (inCombat != state.wasInCombat)
+        WakeLocked(state, inCombat ? "entered combat" : "left combat");
+    if (chat)
+        WakeLocked(state, "player message");
+
+    state.wasMoving = moving;
+    state.wasInCombat = inCombat;
+}
+
+void BotBuddyWakeScheduler::Forget(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _bots.erase(botGuid);
+}
+
+bool BotBuddyWakeScheduler::IsAwake(uint64_t botGuid)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    auto it = _bots.find(botGuid);
+    if (it == _bots.end()) return true;
+
+    WakeState& state = it->second;
+    if (!state.awake && std::chrono::steady_clock::now() >= state.fallbackAt)
+        WakeLocked(state, "fallback timer");
+    return state.awake;
+}
+
+std::vector<std::string> BotBuddyWakeScheduler::GetSummary()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    uint64 total = 0;
+    std::string reasons;
+    for (auto const& [reason, count] : _wakesByReason)
+    {
+        total += count;
+        reasons += fmt::format(" {}={}", reason, count);
+    }
+
+    return { fmt::format("wake-ups: total={}{}", total, reasons) };
+}
+
+void BotBuddyWakeEvents::OnPlayerCreatureKill(Player* killer, Creature* /*killed*/)
+{
+    sBotBuddyWakeScheduler->Wake(killer->GetGUID().GetRawValue(), "kill");
+}
+
+void BotBuddyWakeEvents::OnPlayerLootItem(Player* player, Item* /*item*/, uint32 /*count*/, ObjectGuid /*lootguid*/)
+{
+    sBotBuddyWakeScheduler->Wake(player->GetGUID().GetRawValue(), "loot");
+}
+
+void BotBuddyWakeEvents::OnPlayerCompleteQuest(Player* player, Quest const* /*quest*/)
+{
+    sBotBuddyWakeScheduler->Wake(player->GetGUID().GetRawValue(), "quest complete");
+}
+
+void BotBuddyWakeEvents::OnPlayerGossipSelect(Player* player, uint32 /*menu_id*/, uint32 /*sender*/, uint32 /*action*/)
+{
+    sBotBuddyWakeScheduler->Wake(player->GetGUID().GetRawValue(), "gossip");
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "ScriptMgr.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Decides when a bot is worth a new LLM decision. After an action is applied
+// the bot sleeps until something meaningful happens to it (movement ended,
+// kill, loot, quest progress, gossip, combat change, a player message) or a
+// long fallback timer runs out, instead of re-asking while it is mid-walk.
+class BotBuddyWakeScheduler
+{
+public:
+    static BotBuddyWakeScheduler* instance();
+
+    // Safe from any thread; ignored for bots that are not asleep
+    void Wake(uint64_t botGuid, const char* reason);
+
+    // An action was just applied: sleep until an event or the fallback timer
+    void Sleep(uint64_t botGuid);
+
+    // World tick: turns movement and combat transitions into wake-ups
+    void Poll(Player* bot);
+
+    bool IsAwake(uint64_t botGuid);
+    void Forget(uint64_t botGuid);
+
+    std::vector<std::string> GetSummary();
+
+private:
+    struct WakeState
+    {
+        bool awake = true;
+        std::chrono::steady_clock::time_point fallbackAt;
+        bool wasMoving = false;
+        bool wasInCombat = false;
+    };
+
+    void WakeLocked(WakeState& state, const char* reason);
+
+    std::mutex _lock;
+    std::unordered_map<uint64_t, WakeState> _bots;
+    std::map<std::string, uint64> _wakesByReason;
+};
+
+#define sBotBuddyWakeScheduler BotBuddyWakeScheduler::instance()
+
+class BotBuddyWakeEvents : public PlayerScript
+{
+public:
+    BotBuddyWakeEvents() : PlayerScript("BotBuddyWakeEvents") {}
+
+    void OnPlayerCreatureKill(Player* killer, Creature* killed) override;
+    void OnPlayerLootItem(Player* player, Item* item, uint32 count, ObjectGuid lootguid) override;
+    void OnPlayerCompleteQuest(Player* player, Quest const* quest) override;
+    void OnPlayerGossipSelect(Player* player, uint32 menu_id, uint32 sender, uint32 action) override;
+};